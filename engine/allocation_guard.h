@@ -0,0 +1,44 @@
+#ifndef ALLOCATION_GUARD_H
+#define ALLOCATION_GUARD_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// compile with -DDEBUG_ALLOCATIONS to abort when the search allocates on the heap.
+// without it NoAllocations is empty and costs nothing
+
+namespace Chess::Engine::Debug{
+
+#ifdef DEBUG_ALLOCATIONS
+    inline thread_local int no_allocation_scopes = 0; // NoAllocations alive on this thread
+
+    /// @brief any heap allocation on this thread while one of these exists aborts
+    struct NoAllocations{
+        NoAllocations() { no_allocation_scopes++; }
+        ~NoAllocations(){ no_allocation_scopes--; }
+    };
+#else
+    struct NoAllocations{};
+#endif
+
+} // namespace Chess::Engine::Debug
+
+
+#ifdef DEBUG_ALLOCATIONS
+// replaces the global allocation functions, so this header can only be included in one translation unit per program
+void* operator new(std::size_t size){
+    if (Chess::Engine::Debug::no_allocation_scopes){
+        std::fputs("heap allocation in the search\n", stderr);
+        std::abort();
+    }
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+
+#endif
@@ -8,10 +8,15 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <memory>
 
 #include "..\logger.h"
 #include "..\chess\types.h"
 #include "engine_types.h"
+#include "time_manager.h"
+#include "allocation_guard.h"
+#include "mcts.h"
+#include "mate_solver.h"
 #include "..\transposition_table\tt.h"
 #include "..\chess\board.h"
 #include "..\chess\move_generator.h"
@@ -24,14 +29,57 @@ namespace Chess{
 
             private:
                 MoveGeneration move_gen;
-                uint64_t nodes_searched;
+                std::atomic<uint64_t> nodes_searched = 0; // atomic so the thread which started the helpers can add up their nodes
                 uint64_t ab_prune_count;
                 uint64_t tt_use_count;
+                uint64_t movegen_count;       // move generations in negamax
+                uint64_t movegen_saved_count; // negamax nodes which returned before generating moves
+                uint64_t node_limit = 0; // stop the search after this many nodes, 0 for no limit
+                TimeManager time_manager;
+                Move ponder_move = 0; // second move of the pv from the last finished iteration
+
+                // helper threads for parallel search. helpers[i] is searched by helper_threads[i]
+                std::vector<std::unique_ptr<Engine>> helpers;
+                std::vector<std::thread> helper_threads;
+                bool defer_moves = false; // ABDADA, defer moves which another thread is searching
+
+                MCTS::Tree mcts_tree; // only allocated once a search uses it. helpers search the tree of the engine that started them
+                MateSolver mate_solver; // go mate
+
+                // move ordering
+                Depth ply = 0; // distance from the root of the search
+                Move killers[Evaluations::MAX_PLY][2] = {}; // quiet moves which caused a beta cutoff at each ply
+                int history  [2][64][64] = {}; // [turn][from][to] added to when a quiet move causes a beta cutoff
+                int butterfly[2][64][64] = {}; // [turn][from][to] added to whenever a quiet move is searched
+                Move countermoves[16][64] = {}; // [previous piece][previous to] quiet move which caused a beta cutoff in reply
+                bool null_move[Evaluations::MAX_PLY] = {}; // whether a null move was played at each ply, so the move_stack is behind
+                Depth null_move_min_ply = 0; // no null moves before this ply, while a null move cutoff is being verified
+                Evaluation static_evals[Evaluations::MAX_PLY] = {}; // static eval at each ply, Evaluations::NO_EVAL if in check
+
+                // triangular pv table. pv_table[ply] is the best line found from ply, pv_length[ply] moves long
+                Move pv_table[Evaluations::MAX_PLY][Evaluations::MAX_PLY];
+                int  pv_length[Evaluations::MAX_PLY] = {};
+                int capture_history[16][64][7] = {}; // [piece][to][captured piece type] raised when a capture causes a beta cutoff
+                // [previous piece type][previous to][piece type][to] for the move 1 and 2 plies back
+                std::vector<int> continuation_history[2] = {std::vector<int>(Values::MoveOrdering::CONTINUATION_SIZE), std::vector<int>(Values::MoveOrdering::CONTINUATION_SIZE)};
 
             public:
                 std::atomic_bool stop_search;
+                std::atomic_bool pondering = false; // searching on the opponents time. time limits are ignored and bestmove waits for ponderhit or stop
+                int thread_count = 1;
+                int smp_mode = Values::SMP::LAZY_SMP;
+                int move_ordering_mode = Values::MoveOrdering::HISTORY;
+                int multi_pv = 1; // amount of best lines to search and print at the root
+                int root_search = Values::RootSearch::PVS; // how each iteration finds the eval at the root
+                int search_mode = Values::SearchMode::ALPHA_BETA;
+                int mcts_leaf = Values::MCTS::LEAF_QSEARCH; // how the tree search values leaves
+                std::vector<Move> search_moves; // go searchmoves, only these root moves are searched. empty to search every move
+                bool debug = false; // uci debug on, also prints the search counters which are always logged
                 
             public:
+                /// @brief searches and prints bestmove. stop_search has to be cleared by the caller, so a stop sent before the search thread starts isnt lost
+                /// @param board 
+                /// @param search_limits 
                 void go(Board& board, SearchLimit search_limits){
 
                     // if theres only 1 legal move, return that legal move (and is playing a game)
@@ -39,14 +87,51 @@ namespace Chess{
                     if (search_limits.wtime || search_limits.btime || search_limits.winc || search_limits.binc){
                         if (move_gen.getLegalMoves(board).count == 1) best_move = move_gen.getLegalMoves(board)[0];
                     }
-                    if (best_move == 0) best_move = getBestMove(board, search_limits, true);
+                    ponder_move = 0;
+                    if (best_move == 0 && search_limits.mate){
+                        best_move = (board.turn == Colours::WHITE) ? solveMate<Colours::WHITE>(board, search_limits)
+                                                                   : solveMate<Colours::BLACK>(board, search_limits);
+                    }
+                    else if (best_move == 0 && search_mode == Values::SearchMode::MCTS){
+                        best_move = (board.turn == Colours::WHITE) ? getBestMoveMCTS<Colours::WHITE>(board, search_limits, true)
+                                                                   : getBestMoveMCTS<Colours::BLACK>(board, search_limits, true);
+                    }
+                    else if (best_move == 0){
+                        best_move = (board.turn == Colours::WHITE) ? getBestMove<Colours::WHITE>(board, search_limits, true)
+                                                                   : getBestMove<Colours::BLACK>(board, search_limits, true);
+                    }
 
+                    // the search can finish before the opponent moves, bestmove cant be sent until ponderhit or stop
+                    while (pondering){
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+
+                    std::string bestmove_str = "bestmove " + Chess::Visuals::moveToString(best_move);
+                    if (ponder_move) bestmove_str += " ponder " + Chess::Visuals::moveToString(ponder_move);
+                    bestmove_str += "\n";
+                    Logger::log(bestmove_str);
+                    std::cout << bestmove_str << std::flush; // printed in one go as the uci loop prints from another thread
+                }
 
-                    Logger::log("bestmove " + Chess::Visuals::moveToString(best_move) + "\n");
-                    std::cout << "bestmove " << Chess::Visuals::moveToString(best_move) << '\n';
+                /// @brief the opponent played the pondered move, carry on searching with the real time limits from now
+                void ponderhit(){
+                    time_manager.restart();
+                    pondering = false;
+                }
+
+                /// @brief nodes searched by this engine and its helper threads
+                /// @return 
+                uint64_t getNodesSearched(){
+                    uint64_t nodes = nodes_searched.load(std::memory_order_relaxed);
+                    // helpers past thread_count - 1 are left over from searches with more threads
+                    for (int i = 0; i < std::min<int>(helpers.size(), thread_count - 1); i++){
+                        nodes += helpers[i]->nodes_searched.load(std::memory_order_relaxed);
+                    }
+                    return nodes;
                 }
 
                 Move getBestMove(Board& board, SearchLimit search_limits, bool print = false){
+                    stop_search = false;
 
                     if (board.turn == Colours::WHITE){
                         return getBestMove<Colours::WHITE>(board, search_limits, print);
@@ -54,33 +139,46 @@ namespace Chess{
                     return getBestMove<Colours::BLACK>(board, search_limits, print);                    
                 }
 
+                /// @brief iterative deepening with aspiration windows and multipv
+                /// @param board 
+                /// @param search_limits 
+                /// @param print whether to print info lines
+                /// @param start_clock false to carry on with the clock of a search which already started, like go mate falling back to this
+                /// @return 
                 template<Colour turn>
-                Move getBestMove(Board& board, SearchLimit search_limits, bool print = false){
+                Move getBestMove(Board& board, SearchLimit search_limits, bool print = false, bool start_clock = true){
 
-                    stop_search = false;
+                    if (start_clock) time_manager.start(search_limits, turn);
 
-                    // start the stop search timer
-                    std::thread timer_thread(&Engine::startSearchTimer, this, getSearchTime<turn>(search_limits));
+                    startHelpers<turn>(board, search_limits);
 
                     auto start = std::chrono::high_resolution_clock::now();
 
+                    node_limit     = search_limits.nodes;
                     nodes_searched = 0;
                     ab_prune_count = 0;
                     tt_use_count   = 0;
+                    movegen_count       = 0;
+                    movegen_saved_count = 0;
+
+                    ply = 0;
+                    clearKillers();
+                    ageHistory();
+                    ponder_move = 0;
+                    reserveMoveStack(board);
 
                     bool for_game = search_limits.wtime || search_limits.btime || search_limits.winc || search_limits.binc;
                     
 
                     LegalMovesArray moves = move_gen.generateLegalMoves<turn>(board);
+                    restrictRootMoves(moves);
                     sortMoves<true>(board, moves);
-                    std::vector<MoveOrderingStruct> move_ordering;
-                    move_ordering.resize(moves.count);
+                    MoveOrderingStruct move_ordering[std::size(moves.moves)];
                     // add moves to move ordering
                     for (int i = 0; i < moves.count; i++) move_ordering[i].move = moves[i];
 
                     Evaluation alpha = -Evaluations::EVAL_MATE;
                     Evaluation beta  =  Evaluations::EVAL_MATE;
-                    Evaluation b     =  Evaluations::EVAL_MATE;
 
                     Move best_move = moves[0];
                     Move best_move_this_iter = moves[0];
@@ -90,159 +188,369 @@ namespace Chess{
 
                     // loop through each move and negamax them
                     Move move;
-                    bool is_capture;
-                    bool in_ab_window;
+                    Depth reduction;
+                    bool in_check = board.inCheck<turn>();
+                    static_evals[0] = in_check ? Evaluations::NO_EVAL : staticEvaluate<turn>(board);
+
+                    // aspiration window
+                    Evaluation window_alpha;
+                    Evaluation window_delta;
+
+                    // mtd(f), the eval is known to be between lower and upper
+                    bool mtdf = root_search == Values::RootSearch::MTDF;
+                    Evaluation lower = -Evaluations::EVAL_MATE;
+                    Evaluation upper =  Evaluations::EVAL_MATE;
+                    Move mtdf_best_move = 0;
+                    bool mtdf_confirming = false;
+
+                    // multipv, line k is searched without the best moves of lines 0 to k - 1, which are kept at the front of moves
+                    int line_count = std::max(1, std::min(multi_pv, (int)moves.count));
+                    Evaluation previous_evals[std::size(moves.moves)] = {};
+                    std::vector<RootLine> lines(line_count);
 
                     // iterative deepening
                     for (Depth depth = 1; depth <= max_depth; depth++){
 
-                        in_ab_window = false;
+                        for (int pv_index = 0; pv_index < line_count; pv_index++){
 
-                        for (int i = 0; i < moves.count; i++){
-                            move = moves[i];
-                            // move_ordering[i].move = move;
-
-                            is_capture = board.all_pieces & Bitboards::getBit(Moves::to(move));
-                            
-                            board.playMove(move);
-    
-                            // late move reduction
-                            search_depth = (i < LMR::moves ||
-                                            board.inCheck() ||
-                                            is_capture)
-                                            ? depth 
-                                            : LMR::getLMRDepth(depth);
-    
-                            // PVS
-                            // Evaluation eval = -negamax<!turn>(board, search_depth - 1, -beta, -alpha);;
-                            Evaluation eval;
-                            if (i == 0){
-                                // search with normal window
-                                eval = -negamax<!turn>(board, search_depth - 1, -beta, -alpha);
+                            // search a small window around the previous iterations eval. if the eval is outside the window, grow the window on that side and search again
+                            Evaluation previous_eval = previous_evals[pv_index];
+                            window_delta = Values::Aspiration::START_DELTA;
+                            if (depth >= Values::Aspiration::MIN_DEPTH && !Evaluations::is_decisive(previous_eval)){
+                                window_alpha = std::max(previous_eval - window_delta, -Evaluations::EVAL_MATE);
+                                beta         = std::min(previous_eval + window_delta,  Evaluations::EVAL_MATE);
                             }
                             else{
-                                // search with alpha - 1 to alpha window
-                                eval = -negamax<!turn>(board, search_depth - 1, -alpha - 1, -alpha);
-        
-                                if (eval > alpha && beta - alpha > 1){
-                                    eval = -negamax<!turn>(board, search_depth - 1, -beta, -alpha);
-                                }
+                                window_alpha = -Evaluations::EVAL_MATE;
+                                beta         =  Evaluations::EVAL_MATE;
                             }
 
+                            if (mtdf){
+                                // the first zero window is at the previous iterations eval
+                                lower = -Evaluations::EVAL_MATE;
+                                upper =  Evaluations::EVAL_MATE;
+                                mtdf_best_move = 0;
+                                mtdf_confirming = false;
+                                beta         = std::clamp(previous_eval, -Evaluations::EVAL_MATE + 1, Evaluations::EVAL_MATE);
+                                window_alpha = beta - 1;
+                            }
 
-                            board.undoMove();
-    
-                            // if stop search or is mate, return the best move
-                            if (stop_search || Evaluations::is_win(eval)){
-                                if (Evaluations::is_win(eval) && !stop_search){
-                                    auto end = std::chrono::high_resolution_clock::now();
-                                    std::chrono::duration<double> duration = end - start;
-                                    double time_taken = duration.count();
-                                    alpha     = eval;
-                                    best_move = move;
-                                    std::string info_str = std::string("info") +
-                                                           " depth "    + std::to_string(depth) +
-                                                           " nodes "    + std::to_string(nodes_searched) +
-                                                           " time "     + std::to_string((int)(time_taken * 1000)) +
-                                                           " nps "      + std::to_string((int)(nodes_searched / time_taken)) +
-                                                           " score cp " + std::to_string((int)Evaluations::normalise(alpha, turn)) +
-                                                           " pv "       + getPrincipalVariation(board, best_move) +
-                                                           '\n';
-                                    Logger::log(info_str);
-                                    if (print){
-                                        std::cout << info_str;
+                            while (true){
+
+                                alpha = window_alpha;
+                                pv_length[0] = 0;
+                                best_move_this_iter = moves[pv_index];
+
+                                for (int i = pv_index; i < moves.count; i++){
+                                    move = moves[i];
+
+                                    reduction = 0;
+                                    if (i - pv_index >= LMR::moves && depth >= LMR::min_depth && isQuiet(board, move) && !in_check){
+                                        reduction = getReduction<turn>(board, move, depth, i - pv_index, true, true, false);
+                                    }
+                                    
+                                    Evaluation eval;
+                                    {
+                                        [[maybe_unused]] Debug::NoAllocations no_allocations; // nothing below the root touches the heap
+
+                                        board.playMove(move);
+                                        ply++;
+            
+                                        // late move reduction
+                                        if (board.inCheck()) reduction = 0;
+                                        search_depth = depth - reduction;
+            
+                                        // PVS
+                                        if (i == pv_index){
+                                            // search with normal window
+                                            eval = -negamax<!turn>(board, depth - 1, -beta, -alpha);
+                                        }
+                                        else{
+                                            // search with alpha - 1 to alpha window
+                                            eval = -negamax<!turn>(board, search_depth - 1, -alpha - 1, -alpha);
+
+                                            // the reduced search beat alpha, check it at the full depth
+                                            if (eval > alpha && reduction){
+                                                eval = -negamax<!turn>(board, depth - 1, -alpha - 1, -alpha);
+                                            }
+                
+                                            if (eval > alpha && beta - alpha > 1){
+                                                eval = -negamax<!turn>(board, depth - 1, -beta, -alpha);
+                                            }
+                                        }
+
+
+                                        board.undoMove();
+                                        ply--;
+                                    }
+            
+                                    // if stop search or the best line is mate, return the best move
+                                    if (stop_search || (Evaluations::is_win(eval) && pv_index == 0)){
+                                        if (Evaluations::is_win(eval) && !stop_search){
+                                            alpha     = eval;
+                                            best_move = move;
+                                            updatePV(move);
+                                            std::string info_str = getInfoString<turn>(depth, pv_index, alpha, getPrincipalVariation(best_move), start);
+                                            ponder_move = getPonderMove(best_move);
+                                            Logger::log(info_str);
+                                            if (print){
+                                                std::cout << info_str << std::flush;
+                                            }
+                                        }
+                                        stopSearch();
+                                        return best_move;
+                                    }
+
+                                    // update alpha and best move
+                                    if (eval > alpha){
+                                        alpha               = eval;
+                                        best_move_this_iter = move;
+                                        updatePV(move);
+                                        move_ordering[i].importance = eval;
+                                        move_ordering[i].raised_alpha = true;
+                                    }
+                                    else{
+                                        move_ordering[i].importance = eval;
+                                        move_ordering[i].raised_alpha = false;
+                                    }
+
+                                    // fail high, the window needs to grow before the other moves are worth searching
+                                    if (alpha >= beta){
+                                        break;
                                     }
                                 }
-                                stopSearch(timer_thread);
-                                return best_move;
-                            }
 
-                            // update alpha and best move
-                            if (eval > alpha){
-                                in_ab_window        = true;
-                                alpha               = eval;
-                                best_move_this_iter = move;
-                                move_ordering[i].importance = eval;
-                                move_ordering[i].raised_alpha = true;
+                                if (mtdf){
+                                    // the root is fail hard, so a fail high only shows the eval is at least beta and a fail low that its at most beta - 1.
+                                    // evals arent whole numbers, so one can also land inside the window, which makes it exact
+                                    bool raised_alpha = alpha > window_alpha;
+                                    if (raised_alpha){
+                                        lower = alpha;
+                                        if (alpha < beta) upper = alpha;
+                                        mtdf_best_move = best_move_this_iter;
+                                    }
+                                    else{
+                                        upper = alpha;
+                                    }
+
+                                    if (upper - lower <= Values::RootSearch::MTDF_RESOLUTION){
+                                        // finish on a search which raised alpha, so the best move and pv come from a search which proved them
+                                        if (raised_alpha || lower == -Evaluations::EVAL_MATE || mtdf_confirming){
+                                            // a fail low after searching at the lower bound again is search instability, keep the move which failed high
+                                            if (!raised_alpha && mtdf_best_move){
+                                                best_move_this_iter = mtdf_best_move;
+                                                alpha = lower;
+                                            }
+                                            break;
+                                        }
+                                        // search at the lower bound again, which should fail high from the transposition table
+                                        mtdf_confirming = true;
+                                        beta = lower;
+                                    }
+                                    // move the zero window into the gap between the bounds. it grows away from the only bound until there are 2, then halves the gap
+                                    else if (upper ==  Evaluations::EVAL_MATE)                beta = std::min(lower + window_delta, Evaluations::EVAL_MATE);
+                                    else if (lower == -Evaluations::EVAL_MATE)                beta = std::max(upper + 1 - window_delta, -Evaluations::EVAL_MATE + 1);
+                                    else                                                      beta = (lower + upper + 1) / 2;
+
+                                    window_alpha = beta - 1;
+                                    window_delta *= 2;
+                                }
+                                else if (alpha <= window_alpha && window_alpha > -Evaluations::EVAL_MATE){
+                                    // fail low, every move is at most alpha. move the window down and search again
+                                    beta         = (window_alpha + beta) / 2;
+                                    window_alpha = std::max(alpha - window_delta, -Evaluations::EVAL_MATE);
+                                    window_delta *= 2;
+                                }
+                                else if (alpha >= beta && beta < Evaluations::EVAL_MATE){
+                                    // fail high, the best move is at least beta. move the window up and search again
+                                    beta         = std::min(alpha + window_delta, Evaluations::EVAL_MATE);
+                                    window_delta *= 2;
+                                }
+                                else{
+                                    break;
+                                }
                             }
-                            else{
-                                move_ordering[i].importance = eval;
-                                move_ordering[i].raised_alpha = false;
+        
+                            // sort the moves which arent already the best move of a line
+                            std::sort(move_ordering + pv_index, move_ordering + moves.count, [](const MoveOrderingStruct& a, const MoveOrderingStruct& b) {return (a.raised_alpha != b.raised_alpha) ? a.raised_alpha : (a.importance > b.importance);});
+
+                            // make sure this lines best move is at pv_index, so the next line doesnt search it
+                            for (int i = pv_index; i < moves.count; i++){
+                                if (move_ordering[i].move == best_move_this_iter){
+                                    std::rotate(move_ordering + pv_index, move_ordering + i, move_ordering + i + 1);
+                                    break;
+                                }
                             }
-
-                            // if (print){ (debugging only)
-                            //     // print the search info for this depth
-                            //     std::cout << "info";
-                            //     std::cout << " depth "    << depth;
-                            //     std::cout << " nodes "    << nodes_searched;
-                            //     std::cout << " score cp " << (int)alpha;
-                            //     std::cout << " pv "       << getPrincipalVariation(board, move);
-                            //     std::cout << '\n';
-                            //     // std::cout << "extra info";
-                            //     // std::cout << " ab prune " << ab_prune_count;
-                            //     // std::cout << " tt usage " << tt_use_count << '\n';
-                            // }
                             
-                            b = alpha + 1;
-                        }
-    
-                        // sort moves
-                        std::sort(move_ordering.begin(), move_ordering.end(), [](const MoveOrderingStruct& a, const MoveOrderingStruct& b) {return ((a.raised_alpha != b.raised_alpha) && a.raised_alpha) || (a.importance > b.importance);});
-                        
-                        // // // change the moves array
-                        for (int i = 0; i < moves.count; i++){
-                            moves.moves[i] = move_ordering[i].move;
-                        }
-                        
-                        best_move = best_move_this_iter; // update best move
-                        
-                        TT::save(board.hash, alpha, depth, best_move, Values::NodeTypes::EXACT);
+                            // // // change the moves array
+                            for (int i = 0; i < moves.count; i++){
+                                moves.moves[i] = move_ordering[i].move;
+                            }
+                            
+                            previous_evals[pv_index] = alpha;
 
-                        auto end = std::chrono::high_resolution_clock::now();
-                        
-                        std::chrono::duration<double> duration = end - start;
-                        double time_taken = duration.count();
+                            if (pv_index == 0){
+                                best_move = best_move_this_iter; // update best move
+                                TT::save(board.hash, alpha, depth, best_move, Values::NodeTypes::EXACT);
+                                ponder_move = getPonderMove(best_move);
+                            }
 
-                        std::string info_str = std::string("info") +
-                                               " depth "    + std::to_string(depth) +
-                                               " nodes "    + std::to_string(nodes_searched) +
-                                               " time "     + std::to_string((int)(time_taken * 1000)) +
-                                               " nps "      + std::to_string((int)(nodes_searched / time_taken)) +
-                                               " score cp " + std::to_string((int)Evaluations::normalise(alpha, turn)) +
-                                               " pv "       + getPrincipalVariation(board, best_move) +
-                                               '\n';
-                        Logger::log(info_str);
+                            lines[pv_index] = RootLine{alpha, best_move_this_iter, getPonderMove(best_move_this_iter), getPrincipalVariation(best_move_this_iter)};
+                        }
 
-                        if (print){
-                            // print the search info for this depth
-                            std::cout << info_str;
+                        // a later line can end up better than an earlier one, and guis read multipv k as the kth best line. rank them by eval
+                        if (line_count > 1){
+                            std::stable_sort(lines.begin(), lines.end(), [](const RootLine& a, const RootLine& b) {return a.eval > b.eval;});
+                            for (int i = 0; i < line_count; i++){
+                                moves.moves[i]              = lines[i].move;
+                                move_ordering[i].move       = lines[i].move;
+                                move_ordering[i].importance = lines[i].eval;
+                                previous_evals[i]           = lines[i].eval;
+                            }
+                            best_move   = lines[0].move;
+                            ponder_move = lines[0].ponder;
+                            TT::save(board.hash, lines[0].eval, depth, best_move, Values::NodeTypes::EXACT);
                         }
 
-                        // decrease alpha for the next depth
-                        if (in_ab_window && false){
-                            alpha -= 40;
+                        for (int i = 0; i < line_count; i++){
+                            std::string info_str = getInfoString<turn>(depth, i, lines[i].eval, lines[i].pv, start);
+                            Logger::log(info_str);
+
+                            if (print){
+                                // print the search info for this line
+                                std::cout << info_str << std::flush;
+                            }
                         }
-                        else{
-                            alpha -= 1000;
+
+                        std::string counters_str = std::string("info string") +
+                                                   " ttcutoffs "    + std::to_string(tt_use_count) +
+                                                   " movegens "     + std::to_string(movegen_count) +
+                                                   " movegensaved " + std::to_string(movegen_saved_count) +
+                                                   '\n';
+                        Logger::log(counters_str);
+
+                        if (print && debug){
+                            std::cout << counters_str << std::flush;
                         }
                         
                         // if the best move is much better than other moves at a reasonable depth and for_game is true, return the best move
-                        if (move_ordering[0].importance - 500 > move_ordering[1].importance && depth > 8 && for_game){
-                            stopSearch(timer_thread);
+                        if (moves.count > 1 && move_ordering[0].importance - 500 > move_ordering[1].importance && depth > 8 && for_game && !pondering){
+                            stopSearch();
                             return best_move;
                         }
 
+                        // not enough time left to finish another iteration
+                        if (!pondering && time_manager.softLimitReached()){
+                            break;
+                        }
 
-                        
                     }
 
-                    stopSearch(timer_thread);
+                    stopSearch();
                     return best_move;
 
                 }
 
+                /// @brief go mate. looks for the mate with the proof number solver, and searches normally if there isnt one
+                /// @param board 
+                /// @param search_limits 
+                /// @return 
+                template<Colour turn>
+                Move solveMate(Board& board, SearchLimit search_limits){
+                    time_manager.start(search_limits, turn);
+
+                    std::vector<Move> pv;
+                    int mate = mate_solver.solve(board, search_limits.mate, stop_search, pondering, time_manager, search_limits.nodes, pv, true);
+                    nodes_searched = mate_solver.getNodes();
+                    if (mate && !pv.empty()){
+                        ponder_move = pv.size() >= 2 ? pv[1] : 0;
+                        return pv[0];
+                    }
+
+                    if (stop_search){
+                        // the solver used up the limit or was stopped. a depth 1 search is quick and still better than a move which hasnt been searched
+                        std::cout << "info string mate search stopped before a mate in " << search_limits.mate << " was found\n" << std::flush;
+                        stop_search = false;
+                        SearchLimit depth_one;
+                        depth_one.depth = 1;
+                        return getBestMove<turn>(board, depth_one, true);
+                    }
+
+                    std::cout << "info string no mate in " << search_limits.mate << " found\n" << std::flush;
+
+                    // search normally with whats left of the limits
+                    if (!search_limits.time && !search_limits.wtime && !search_limits.btime && !search_limits.winc && !search_limits.binc && !search_limits.depth && !search_limits.nodes){
+                        search_limits.depth = 2 * search_limits.mate;
+                    }
+                    if (search_limits.nodes) search_limits.nodes -= std::min(search_limits.nodes, mate_solver.getNodes());
+                    search_limits.mate = 0;
+                    return getBestMove<turn>(board, search_limits, true, false);
+                }
+
+                /// @brief makes room for every move the search can play on the move stack, so playMove never reallocates it.
+                /// negamax plies are below MAX_PLY and qsearch cant go deeper than the captures left on the board
+                /// @param board 
+                void reserveMoveStack(Board& board){
+                    board.move_stack.reserve(board.move_stack.size() + 2 * Evaluations::MAX_PLY);
+                }
+
+                /// @brief whether the opponent passed with a null move to reach this node
+                /// @return 
+                bool previousNullMove(){
+                    return ply > 0 && ply <= Evaluations::MAX_PLY && null_move[ply - 1];
+                }
+
+                /// @brief whether the side has a piece other than pawns and the king, so zugzwang is unlikely
+                /// @param board 
+                /// @return 
+                template<Colour turn>
+                bool hasNonPawnMaterial(Board& board){
+                    return board.colours[turn] & ~(board.pieces[Pieces::gen(Pieces::W_PAWN, turn)] | board.pieces[Pieces::gen(Pieces::W_KING, turn)]);
+                }
+
+                /// @brief removes root moves which arent in search_moves. does nothing if none of them are legal
+                /// @param moves 
+                void restrictRootMoves(LegalMovesArray& moves){
+                    if (search_moves.empty()) return;
+
+                    LegalMovesArray restricted;
+                    for (Move move : moves){
+                        if (std::find(search_moves.begin(), search_moves.end(), move) != search_moves.end()){
+                            restricted += move;
+                        }
+                    }
+
+                    if (restricted.count) moves = restricted;
+                }
+
+                /// @brief the uci info line for a finished line of the root search
+                /// @param depth 
+                /// @param pv_index which multipv line it is, from 0
+                /// @param eval 
+                /// @param pv the line, from getPrincipalVariation
+                /// @param start when the search started
+                /// @return 
+                template<Colour turn>
+                std::string getInfoString(Depth depth, int pv_index, Evaluation eval, const std::string& pv, std::chrono::high_resolution_clock::time_point start){
+                    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+                    double time_taken = duration.count();
+                    uint64_t nodes = getNodesSearched();
+
+                    return std::string("info") +
+                           " depth "    + std::to_string(depth) +
+                           (multi_pv > 1 ? " multipv " + std::to_string(pv_index + 1) : "") +
+                           " nodes "    + std::to_string(nodes) +
+                           " time "     + std::to_string((int)(time_taken * 1000)) +
+                           " nps "      + std::to_string((int)(nodes / time_taken)) +
+                           " score cp " + std::to_string((int)Evaluations::normalise(eval, turn)) +
+                           " pv "       + pv +
+                           '\n';
+                }
+
                 template<Colour turn>
                 Evaluation negamax(Board& board, Depth depth, Evaluation alpha, Evaluation beta){
+                    if (ply < Evaluations::MAX_PLY) pv_length[ply] = 0;
+
                     if (stop_search){
                         return 0;
                     }
@@ -262,56 +570,156 @@ namespace Chess{
                         return eval;
                     }
 
-                    LegalMovesArray moves = move_gen.generateLegalMoves<turn>(board);
-                    // check transposition table
+                    Move tt_move = 0;
+                    // check transposition table before generating moves, so cutoffs dont pay for move generation
                     {
                         TT::TTData entry = TT::getEntry(board.hash);
-                        if (entry.hash == board.hash && entry.depth >= depth){
-                            bool legal = false;
-                            if (entry.move){
-                                // check if the saved move is legal
-                                for (Move move : moves){
-                                    if (entry.move == move) { legal = true; break; }
-                                }
-                            }
-                            if (legal){
+                        // the move is checked to guard against hash collisions. its compared to the legal moves when ordering
+                        if (entry.hash == board.hash && isPseudoLegal<turn>(board, entry.move)){
+                            tt_move = entry.move;
+                            // no cutoffs in pv nodes so the pv table has the full line
+                            if (entry.depth >= depth && beta - alpha == 1){
                                 Evaluation adjusted_eval = entry.eval;
                                 if (Evaluations::is_win (adjusted_eval)) adjusted_eval = std::max(adjusted_eval - depth, Evaluations::EVAL_MATE_IN_MAX_PLY);
                                 if (Evaluations::is_loss(adjusted_eval)) adjusted_eval = std::min(adjusted_eval + depth, Evaluations::EVAL_MATED_IN_MAX_PLY);
-                                if (entry.node_type == Values::NodeTypes::EXACT) {
-                                    return adjusted_eval;
-                                }
-                                else if (entry.node_type == Values::NodeTypes::FAIL_LOW && adjusted_eval <= alpha) {
-                                    return adjusted_eval;
-                                }
-                                else if (entry.node_type == Values::NodeTypes::FAIL_HIGH && adjusted_eval >= beta) {
+                                if (entry.node_type == Values::NodeTypes::EXACT ||
+                                   (entry.node_type == Values::NodeTypes::FAIL_LOW  && adjusted_eval <= alpha) ||
+                                   (entry.node_type == Values::NodeTypes::FAIL_HIGH && adjusted_eval >= beta)) {
+                                    tt_use_count++;
+                                    movegen_saved_count++;
                                     return adjusted_eval;
                                 }
                             }
                         }
                     }
 
+                    // internal iterative reduction - without a tt move the ordering is poor, so search this node less deeply
+                    if (!tt_move && depth >= Values::Negamax::IIR_MIN_DEPTH){
+                        depth--;
+                    }
+
                     bool in_check = board.inCheck<turn>();
-                    { // null move pruning
-                        if (!in_check){
-                            Square ep = board.playNull();
-                            Evaluation eval = -negamax<!turn>(board, depth - Values::Negamax::NULL_MOVE_PRUNE_REDUCTION, -beta, -(beta - 1));
-                            board.undoNull(ep);
-                            if (eval >= beta){
+                    bool pv_node  = beta - alpha > 1;
+
+                    Evaluation static_eval = in_check ? Evaluations::NO_EVAL : staticEvaluate<turn>(board);
+                    if (ply < Evaluations::MAX_PLY) static_evals[ply] = static_eval;
+                    bool improving = isImproving(static_eval);
+
+                    // static eval pruning, only in null window nodes which arent in check or near mate scores
+                    bool futile = false;
+                    if (!in_check && !pv_node && !Evaluations::is_decisive(alpha) && !Evaluations::is_decisive(beta)){
+                        // reverse futility pruning - the position is so good that it should still be above beta after any reply
+                        if (depth <= Values::Negamax::REVERSE_FUTILITY_MAX_DEPTH && static_eval - Values::Negamax::REVERSE_FUTILITY_MARGIN * depth >= beta){
+                            movegen_saved_count++;
+                            return static_eval;
+                        }
+
+                        // razoring - the position is so bad that only captures could save it, check with qsearch
+                        if (depth <= Values::Negamax::RAZORING_MAX_DEPTH && static_eval + Values::Negamax::RAZORING_DELTA * depth < alpha){
+                            Evaluation eval = qsearch<turn>(board, alpha, beta);
+                            if (eval < beta){
+                                movegen_saved_count++;
+                                return eval;
+                            }
+                        }
+
+                        // futility pruning - quiet moves are unlikely to raise the eval above alpha
+                        futile = depth <= Values::Negamax::FUTILITY_MAX_DEPTH && static_eval + Values::Negamax::FUTILITY_MARGIN * depth <= alpha;
+                    }
+
+                    // null move pruning - if passing still keeps the eval above beta, a real move will too.
+                    // not in pawn endgames where passing could be better than any move (zugzwang), or straight after the opponent passed
+                    if (!in_check && depth >= Values::Negamax::NULL_MOVE_MIN_DEPTH && static_eval >= beta && !Evaluations::is_decisive(beta) &&
+                        ply >= null_move_min_ply && !previousNullMove() && hasNonPawnMaterial<turn>(board)){
+
+                        Depth reduction = Values::Negamax::NULL_MOVE_PRUNE_REDUCTION + depth / Values::Negamax::NULL_MOVE_DEPTH_DIVISOR +
+                                          std::min<Depth>((static_eval - beta) / Values::Negamax::NULL_MOVE_EVAL_DIVISOR, Values::Negamax::NULL_MOVE_MAX_EVAL_REDUCTION);
+
+                        Square ep = board.playNull();
+                        if (ply < Evaluations::MAX_PLY) null_move[ply] = true;
+                        ply++;
+                        Evaluation eval = -negamax<!turn>(board, depth - reduction, -beta, -(beta - 1));
+                        ply--;
+                        if (ply < Evaluations::MAX_PLY) null_move[ply] = false;
+                        board.undoNull(ep);
+
+                        if (eval >= beta && !stop_search){
+                            if (Evaluations::is_win(eval)) eval = beta; // passing cant prove a mate
+
+                            if (depth < Values::Negamax::NULL_MOVE_VERIFICATION_DEPTH){
+                                movegen_saved_count++;
+                                return eval;
+                            }
+
+                            // verification search - search this side to a reduced depth without null moves for the next few plies
+                            Depth previous_min_ply = null_move_min_ply;
+                            null_move_min_ply = ply + 3 * (depth - reduction) / 4;
+                            Evaluation verified_eval = negamax<turn>(board, depth - reduction, beta - 1, beta);
+                            null_move_min_ply = previous_min_ply;
+
+                            if (verified_eval >= beta){
+                                movegen_saved_count++;
                                 return eval;
                             }
                         }
                     }
 
+                    // probcut - if a good capture beats beta by a margin in a shallow search, it very likely beats beta in the full search
+                    if (!pv_node && !in_check && depth >= Values::Negamax::PROBCUT_MIN_DEPTH && !Evaluations::is_decisive(beta)){
+                        Evaluation probcut_beta = beta + Values::Negamax::PROBCUT_MARGIN;
+                        Depth probcut_depth = depth - Values::Negamax::PROBCUT_REDUCTION;
+
+                        // not worth it when the table already says a search this deep didnt reach probcut_beta
+                        TT::TTData entry = TT::getEntry(board.hash);
+                        bool tt_below = entry.hash == board.hash && entry.depth >= probcut_depth && entry.eval < probcut_beta && entry.node_type != Values::NodeTypes::FAIL_HIGH;
+
+                        if (!tt_below){
+                            LegalMovesArray captures = move_gen.generateTacticalMoves<turn>(board);
+                            orderCaptures<turn>(board, captures, tt_move);
+
+                            for (Move move : captures){
+                                // only captures which win enough material by SEE to get near probcut_beta
+                                if (isQuiet(board, move) || see(board, move) < std::max<Evaluation>(0, probcut_beta - static_eval)) continue;
+
+                                board.playMove(move);
+                                ply++;
+
+                                // qsearch first, so the shallow search is only done for captures which hold up
+                                Evaluation eval = -qsearch<!turn>(board, -probcut_beta, -probcut_beta + 1);
+                                if (eval >= probcut_beta){
+                                    eval = -negamax<!turn>(board, probcut_depth - 1, -probcut_beta, -probcut_beta + 1);
+                                }
+
+                                ply--;
+                                board.undoMove();
+
+                                if (eval >= probcut_beta && !stop_search){
+                                    TT::save(board.hash, eval, probcut_depth, move, Values::NodeTypes::FAIL_HIGH);
+                                    movegen_saved_count++;
+                                    return eval;
+                                }
+                            }
+                        }
+                    }
+
+                    LegalMovesArray moves = move_gen.generateLegalMoves<turn>(board);
+                    movegen_count++;
+
                     if (moves.count == 0){ // mate and stalemate cases
-                        if (board.inCheck()){
+                        if (in_check){
                             return -Evaluations::getMateEval(depth);
                         }
                         return 0;
                     }
 
+                    // only helper threads search the root with negamax, go searchmoves applies to them too
+                    if (ply == 0) restrictRootMoves(moves);
+
                     { // sort moves
-                        if (depth > 3){
+                        if (move_ordering_mode == Values::MoveOrdering::HISTORY){
+                            orderMoves<turn>(board, moves, tt_move);
+                        }
+                        else if (depth > 3){
                             sortMoves<false>(board, moves, alpha, beta);
                         }
                         else{
@@ -324,53 +732,118 @@ namespace Chess{
                     Depth search_depth;
                     Move move;
                     Move best_move = 0;
-                    bool is_capture;
+                    bool is_quiet;
+                    Move quiets_searched[std::size(moves.moves)]; // quiet moves which didnt cause a cutoff, their continuation history is lowered
+                    int quiet_count = 0;
+                    Move captures_searched[std::size(moves.moves)]; // same for capture history
+                    int capture_count = 0;
+                    bool tt_move_capture = tt_move && !isQuiet(board, tt_move);
+                    bool found_non_losing = false; // whether a searched move didnt get a mated score
+                    Depth reduction;
+                    int move_count = moves.count; // moves after this have been deferred and are not deferred again
+                    int deferred_indexes[std::size(moves.moves)]; // where each deferred move was in the ordering
                     for (int i = 0; i < moves.count; i++){
                         move = moves[i];
 
-                        is_capture = board.all_pieces & Bitboards::getBit(Moves::to(move));
+                        is_quiet   = isQuiet(board, move);
+                        int move_index = (i < move_count) ? i : deferred_indexes[i - move_count]; // so deferring a move doesnt make it late
+
+                        // late move pruning and history pruning - once a move which doesnt lose has been found, skip hopeless quiet moves at low depths
+                        if (is_quiet && !pv_node && !in_check && found_non_losing){
+                            if (depth <= Values::Negamax::LATE_MOVE_PRUNING_MAX_DEPTH && move_index >= getLateMoveCount(depth, improving)) continue;
+                            if (depth <= Values::Negamax::HISTORY_PRUNING_MAX_DEPTH && getContinuationHistory(board, move) < -Values::Negamax::HISTORY_PRUNING_MARGIN * depth) continue;
+                        }
+
+                        reduction = 0;
+                        if (move_index >= LMR::moves && depth >= LMR::min_depth && is_quiet && !in_check){
+                            reduction = getReduction<turn>(board, move, depth, move_index, pv_node, improving, tt_move_capture);
+                        }
 
                         // play move
                         board.playMove(move);
 
-                        // late move reduction - if one of the first 4 moves, is in check, captures a piece search at the normal depth
-                        {
-                            search_depth = (i < LMR::moves ||
-                                            in_check ||
-                                            board.inCheck() ||
-                                            is_capture)
-                                            ? depth 
-                                            : LMR::getLMRDepth(depth);
+                        // futility pruning - skip quiet moves that dont give check
+                        if (futile && i > 0 && is_quiet && !board.inCheck()){
+                            board.undoMove();
+                            continue;
+                        }
+
+                        // ABDADA - if another thread is searching this move, move it to the end of the list and search it after the others
+                        if (defer_moves){
+                            if (i > 0 && i < move_count && depth >= Values::SMP::ABDADA_DEFER_DEPTH && moves.count < std::size(moves.moves) && TT::isBeingSearched(board.hash)){
+                                board.undoMove();
+                                deferred_indexes[moves.count - move_count] = i;
+                                moves += move;
+                                continue;
+                            }
+                            TT::startSearching(board.hash);
                         }
+                        ply++;
+
+                        // late move reduction - quiet moves late in the ordering are searched at a lower depth, unless in check or giving check
+                        if (board.inCheck()) reduction = 0;
+                        search_depth = depth - reduction;
 
                         // PVS
                         // Evaluation eval = -negamax<!turn>(board, search_depth - 1, -beta, -alpha);
                         Evaluation eval;
                         if (i == 0){
                             // search with normal window
-                            eval = -negamax<!turn>(board, search_depth - 1, -beta, -alpha);
+                            eval = -negamax<!turn>(board, depth - 1, -beta, -alpha);
                         }
                         else{
                             // search with alpha - 1 to alpha window
                             eval = -negamax<!turn>(board, search_depth - 1, -alpha - 1, -alpha);
+
+                            // the reduced search beat alpha, check it at the full depth
+                            if (eval > alpha && reduction){
+                                eval = -negamax<!turn>(board, depth - 1, -alpha - 1, -alpha);
+                            }
     
                             if (eval > alpha && beta - alpha > 1){
-                                eval = -negamax<!turn>(board, search_depth - 1, -beta, -alpha);
+                                eval = -negamax<!turn>(board, depth - 1, -beta, -alpha);
                             }
                         }
 
+                        if (defer_moves) TT::finishSearching(board.hash);
+
                         // undo move
+                        ply--;
                         board.undoMove();
                         
-                        if (eval > alpha){best_move = move;}
+                        if (eval > alpha){
+                            best_move = move;
+                            updatePV(move);
+                        }
+                        if (!Evaluations::is_loss(eval)) found_non_losing = true;
                         // update alpha
                         alpha = std::max<Evaluation>(eval, alpha);
 
+                        if (is_quiet){
+                            addButterfly<turn>(move, depth);
+                        }
+
                         if (alpha >= beta){
                             ab_prune_count++;
+                            if (is_quiet){
+                                addKiller(move);
+                                addHistory<turn>(move, depth);
+                                addCountermove(board, move);
+                                updateContinuationHistory(board, move, quiets_searched, quiet_count, depth);
+                            }
+                            else{
+                                updateCaptureHistory(board, move, captures_searched, capture_count, depth * depth);
+                            }
                             TT::save(board.hash, alpha, depth, best_move, Values::NodeTypes::FAIL_HIGH);
                             return alpha; // alpha-beta pruning
                         }
+
+                        if (is_quiet){
+                            quiets_searched[quiet_count++] = move;
+                        }
+                        else{
+                            captures_searched[capture_count++] = move;
+                        }
                     }
 
                     if (alpha >= beta) {
@@ -399,24 +872,63 @@ namespace Chess{
                         return 0;
                     }
 
+                    Move tt_move = 0;
+                    {
+                        TT::TTData entry = TT::getEntry(board.hash);
+                        // any entry is deep enough for qsearch. mate scores are left to be searched, as they depend on the ply
+                        if (entry.hash == board.hash){
+                            tt_move = entry.move;
+                            if (!Evaluations::is_decisive(entry.eval) &&
+                               (entry.node_type == Values::NodeTypes::EXACT ||
+                               (entry.node_type == Values::NodeTypes::FAIL_LOW  && entry.eval <= alpha) ||
+                               (entry.node_type == Values::NodeTypes::FAIL_HIGH && entry.eval >= beta))) {
+                                tt_use_count++;
+                                return entry.node_type == Values::NodeTypes::FAIL_HIGH ? beta : entry.node_type == Values::NodeTypes::FAIL_LOW ? alpha : std::clamp(entry.eval, alpha, beta);
+                            }
+                        }
+                    }
+
                     if (board.isCheckmate<turn>()){
                         return Evaluations::EVAL_MATE_IN_MAX_PLY;
                     }
 
+                    bool in_check = board.inCheck<turn>();
+
                     Evaluation standing_pat = staticEvaluate<turn>(board);
 
                     if (standing_pat >= beta){
+                        TT::save(board.hash, standing_pat, Values::QSearch::TT_DEPTH, tt_move, Values::NodeTypes::FAIL_HIGH);
                         return beta;
                     }
 
+                    Evaluation start_alpha = alpha;
                     alpha = std::max<Evaluation>(alpha, standing_pat);
 
                     LegalMovesArray moves = move_gen.generateTacticalMoves<turn>(board); // gets capture moves
-                    sortMoves<true>(board, moves, alpha, beta);
+                    if (move_ordering_mode == Values::MoveOrdering::HISTORY){
+                        orderCaptures<turn>(board, moves, tt_move);
+                    }
+                    else{
+                        sortMoves<true>(board, moves, alpha, beta);
+                    }
 
                     // loop through each move and negamax them
                     bool first_move = true;
+                    Move captures_searched[std::size(moves.moves)]; // captures which didnt cause a cutoff, not the pruned ones
+                    int capture_count = 0;
+                    Move best_move = 0;
                     for (Move move : moves){
+                        if (!in_check){
+                            // delta pruning - even winning the captured piece for free wont raise alpha
+                            Piece captured = getCapturedType(board, move);
+                            Evaluation gain = captured ? Values::Eval::PIECE_MG_VALUES[captured - 1] : 0;
+                            if (Moves::isPromotion(move)) gain += Values::Eval::PIECE_MG_VALUES[Moves::promotionPiece(move) - 1] - Values::Eval::PIECE_MG_VALUES[0];
+                            if (standing_pat + gain + Values::QSearch::BIG_DELTA < alpha) continue;
+
+                            // SEE pruning - the capture loses material
+                            if (see(board, move) < 0) continue;
+                        }
+
                         board.playMove(move);
 
                         // negamax
@@ -438,126 +950,113 @@ namespace Chess{
 
                         board.undoMove();
 
-                        alpha = std::max<Evaluation>(eval, alpha);
+                        if (eval > alpha){
+                            alpha     = eval;
+                            best_move = move;
+                        }
 
                         if (alpha >= beta){
                             ab_prune_count++;
+                            updateCaptureHistory(board, move, captures_searched, capture_count, Values::MoveOrdering::QSEARCH_CAPTURE_BONUS);
+                            if (!stop_search) TT::save(board.hash, alpha, Values::QSearch::TT_DEPTH, move, Values::NodeTypes::FAIL_HIGH);
                             return beta; // alpha-beta pruning
                         }
 
                         first_move = false;
+                        captures_searched[capture_count++] = move;
+                    }
+
+                    if (!stop_search){
+                        TT::save(board.hash, alpha, Values::QSearch::TT_DEPTH, best_move ? best_move : tt_move, alpha > start_alpha ? Values::NodeTypes::EXACT : Values::NodeTypes::FAIL_LOW);
                     }
 
                     return alpha;
                 }
 
 
-                // Evaluation see(Board& board, Square square){
-                //     Bitboard below_square = Bitboards::getBit(square) - 1;
-
-                //     // get pieces on both sides which are attacking or xraying the square
-                //     Bitboard w_pawns   = board.pieces[Pieces::W_PAWN]   &  Bitboards::getPawnAttacks<Colours::BLACK>(Bitboards::getBit(square));
-                //     Bitboard b_pawns   = board.pieces[Pieces::B_PAWN]   &  Bitboards::getPawnAttacks<Colours::WHITE>(Bitboards::getBit(square));
-
-                //     // get pieces that arent truly blockers
-                //     Bitboard diag_non_blockers = board.pieces[Pieces::W_BISHOP] | board.pieces[Pieces::B_BISHOP] | board.pieces[Pieces::W_QUEEN] | board.pieces[Pieces::B_QUEEN] | w_pawns | b_pawns;
-                //     Bitboard hori_non_blockers = board.pieces[Pieces::W_ROOK]   | board.pieces[Pieces::B_ROOK]   | board.pieces[Pieces::W_QUEEN] | board.pieces[Pieces::B_QUEEN];
-
-                //     Bitboard bishop_attacks = Bitboards::getBishopAttacks(board.all_pieces & ~diag_non_blockers, square);
-                //     Bitboard rook_attacks   = Bitboards::getRookAttacks  (board.all_pieces & ~hori_non_blockers, square);
-
-
-                //     // ignore pieces that are already on the square
-                //     Bitboard w_knights = board.pieces[Pieces::W_KNIGHT] &  Bitboards::getKnightAttacks(square);
-                //     Bitboard w_bishops = board.pieces[Pieces::W_BISHOP] &  bishop_attacks;
-                //     Bitboard w_rooks   = board.pieces[Pieces::W_ROOK]   &  rook_attacks;
-                //     Bitboard w_queens  = board.pieces[Pieces::W_QUEEN]  & (bishop_attacks | rook_attacks);
-                //     Bitboard w_kings   = board.pieces[Pieces::W_KING]   &  Bitboards::getKingAttacks(square);
-
-
-                //     Bitboard b_knights = board.pieces[Pieces::B_KNIGHT] &  Bitboards::getKnightAttacks(square);
-                //     Bitboard b_bishops = board.pieces[Pieces::B_BISHOP] &  bishop_attacks;
-                //     Bitboard b_rooks   = board.pieces[Pieces::B_ROOK]   &  rook_attacks;
-                //     Bitboard b_queens  = board.pieces[Pieces::B_QUEEN]  & (bishop_attacks | rook_attacks);
-                //     Bitboard b_kings   = board.pieces[Pieces::B_KING]   &  Bitboards::getKingAttacks(square);
-
-                //     Evaluation eval = 0;
-
-                //     // calculate the see eval
-                //     Colour turn = board.turn;
-                //     Piece smallest_attacker = 0;
-                //     while (true){
-                //         if (turn == Colours::WHITE){
-                //             // get the smallest attacker
-                //             if (w_pawns){
-                //                 smallest_attacker = Pieces::W_PAWN;
-                //                 w_pawns &= w_pawns - 1;
-                //             }
-                //             if (smallest_attacker == Pieces::EMPTY && w_knights){
-                //                 smallest_attacker = Pieces::W_KNIGHT;
-                //                 w_knights &= w_knights - 1;
-                //             }
-                //             if (smallest_attacker == Pieces::EMPTY && w_bishops){
-                //                 // make sure theres no blockers between this and the square (our queen, enemy_bishops, enemy_queen)
-                //                 Bitboard below_bishop = Bitboards::getNextBit(w_bishops) - 1;
-
-                //                 // fast check
-                //                 Bitboard queens_between;
-                //                 if (Bitboards::getNextSquare(w_rooks) > square){
-                //                     queens_between = below_bishop & ~below_square & bishop_attacks & w_queens;
-                //                 }
-                //                 if (Bitboards::getNextSquare(w_rooks) < square){
-                //                     queens_between = below_square & ~below_bishop & bishop_attacks & w_queens;
-                //                 }
-                //                 // make sure its not a queen on the diagonal the bishop isnt on
-                //                 if (queens_between){
-                //                     queens_between &= Bitboards::bitboardThrough(square, Bitboards::getNextSquare(w_bishops));
-                //                 }
-
-                //                 if (!queens_between){
-                //                     smallest_attacker = Pieces::W_BISHOP;
-                //                     w_bishops &= w_bishops - 1;
-                //                 }
-                //             }
-                //             if (smallest_attacker == Pieces::EMPTY && w_rooks){
-                //                 // make sure theres no queen between this and the square
-                //                 Bitboard below_rook = Bitboards::getNextBit(w_rooks) - 1;
-                //                 // if the square is below the rook
-
-                //                 // fast check
-                //                 Bitboard queens_between;
-                //                 if (Bitboards::getNextSquare(w_rooks) > square){
-                //                     queens_between = below_rook & ~below_square & rook_attacks & w_queens;
-                //                 }
-                //                 if (Bitboards::getNextSquare(w_rooks) < square){
-                //                     queens_between = below_square & ~below_rook & rook_attacks & w_queens;
-                //                 }
-                //                 // make sure its not a queen on the horizontal/verticle the rook isnt on
-                //                 if (queens_between){
-                //                     queens_between &= Bitboards::bitboardThrough(square, Bitboards::getNextSquare(w_rooks));
-                //                 }
-
-                //                 if (!queens_between){
-                //                     smallest_attacker = Pieces::W_ROOK;
-                //                     w_rooks &= w_rooks - 1;
-                //                 }
-                //             }
-                //             if (smallest_attacker == Pieces::EMPTY && w_queens){
-                //                 // should be possible as rooks bishops and pawns (only blockers) arent possible
-                //                 smallest_attacker = Pieces::W_QUEEN;
-                //                 w_queens &= w_queens - 1;
-                //             }
-                //             if (smallest_attacker == Pieces::EMPTY && w_kings){
-                //                 // check if its actually legal. if not ignore this
-                //                 smallest_attacker = Pieces::W_KING;
-                //                 w_kings &= w_kings - 1;
-                //             }
-                //         }
-                //         else{
-
-                //         }
-                //     }
-                // }
+                /// @brief static exchange evaluation. the material won by playing move, followed by both sides recapturing on its to square with their least valuable piece
+                /// @param board 
+                /// @param move 
+                /// @return 
+                Evaluation see(Board& board, Move move){
+                    Square from = Moves::from(move);
+                    Square to   = Moves::to  (move);
+
+                    Piece attacker = board.getPieceAt(from);
+                    Piece captured = getCapturedType(board, move);
+                    Colour side    = Pieces::getColour(attacker);
+
+                    Bitboard occupied = board.all_pieces ^ Bitboards::getBit(from);
+                    if (captured == Pieces::W_PAWN && Pieces::typeOf(board.getPieceAt(to)) == Pieces::EMPTY){
+                        occupied ^= Bitboards::getBit(to ^ 8); // en passant
+                    }
+
+                    Evaluation gain[32];
+                    int d = 0;
+                    gain[0] = captured ? getSEEValue(captured) : 0;
+                    Piece attacker_type = Pieces::typeOf(attacker);
+                    if (Moves::isPromotion(move)){
+                        gain[0] += getSEEValue(Moves::promotionPiece(move)) - getSEEValue(Pieces::W_PAWN);
+                        attacker_type = Moves::promotionPiece(move);
+                    }
+
+                    Bitboard attackers = getAttackersTo(board, to, occupied) & occupied;
+
+                    while (d < 31){
+                        d++;
+                        side = !side;
+                        gain[d] = getSEEValue(attacker_type) - gain[d - 1]; // if the piece on the square gets captured
+
+                        // neither side can gain from continuing
+                        if (std::max(-gain[d - 1], gain[d]) < 0) break;
+
+                        // get the least valuable attacker
+                        Bitboard side_attackers = attackers & board.colours[side];
+                        if (!side_attackers) break;
+
+                        Piece type = Pieces::W_PAWN;
+                        Bitboard type_attackers = 0;
+                        for (; type <= Pieces::W_KING; type++){
+                            type_attackers = side_attackers & board.pieces[Pieces::gen(type, side)];
+                            if (type_attackers) break;
+                        }
+
+                        // the king cant capture into a defended square
+                        if (type == Pieces::W_KING && (attackers & board.colours[!side])) break;
+
+                        occupied  ^= Bitboards::getNextBit(type_attackers);
+                        attackers  = getAttackersTo(board, to, occupied) & occupied; // adds sliding pieces behind the one which captured
+                        attacker_type = type;
+                    }
+
+                    while (--d){
+                        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+                    }
+                    return gain[0];
+                }
+
+                /// @brief all pieces of both colours attacking square, with sliding pieces blocked by occupied
+                /// @param board 
+                /// @param square 
+                /// @param occupied 
+                /// @return 
+                Bitboard getAttackersTo(Board& board, Square square, Bitboard occupied){
+                    Bitboard bit = Bitboards::getBit(square);
+                    Bitboard diagonal   = board.pieces[Pieces::W_BISHOP] | board.pieces[Pieces::B_BISHOP] | board.pieces[Pieces::W_QUEEN] | board.pieces[Pieces::B_QUEEN];
+                    Bitboard horizontal = board.pieces[Pieces::W_ROOK]   | board.pieces[Pieces::B_ROOK]   | board.pieces[Pieces::W_QUEEN] | board.pieces[Pieces::B_QUEEN];
+
+                    return (Bitboards::getPawnAttacks<Colours::BLACK>(bit) & board.pieces[Pieces::W_PAWN]) |
+                           (Bitboards::getPawnAttacks<Colours::WHITE>(bit) & board.pieces[Pieces::B_PAWN]) |
+                           (Bitboards::getKnightAttacks(square) & (board.pieces[Pieces::W_KNIGHT] | board.pieces[Pieces::B_KNIGHT])) |
+                           (Bitboards::getKingAttacks  (square) & (board.pieces[Pieces::W_KING]   | board.pieces[Pieces::B_KING]))   |
+                           (Bitboards::getBishopAttacks(occupied, square) & diagonal) |
+                           (Bitboards::getRookAttacks  (occupied, square) & horizontal);
+                }
+
+                Evaluation getSEEValue(Piece type){
+                    if (type == Pieces::W_KING) return Values::QSearch::SEE_KING_VALUE;
+                    return Values::Eval::PIECE_MG_VALUES[type - 1];
+                }
 
 
                 /// @brief returns the evaluation of the board without playing any moves
@@ -565,7 +1064,9 @@ namespace Chess{
                 /// @return 
                 template<Colour turn>
                 Evaluation staticEvaluate(Board& board){
-                    nodes_searched++;
+                    // only this thread writes it, so it doesnt need an atomic increment
+                    nodes_searched.store(nodes_searched.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    checkLimits();
 
                     // EvalByPhase eval = EvalByPhase();
 
@@ -665,8 +1166,8 @@ namespace Chess{
                 void sortMoves(Board& board, LegalMovesArray& moves, Evaluation alpha = 0, Evaluation beta = 0){
 
                     Bitboard defended_squares = board.turn == Colours::WHITE ? board.attackedBitboardNoKing<Colours::BLACK>() : board.attackedBitboardNoKing<Colours::WHITE>();
-                    std::vector<MoveOrderingStruct> move_ordering;
-                    move_ordering.reserve(moves.count);
+                    MoveOrderingStruct move_ordering[std::size(moves.moves)];
+                    int move_count = 0;
 
                     Move best_move = 0;
                     if constexpr (!fast){
@@ -679,11 +1180,11 @@ namespace Chess{
 
                     for (int i = 0; i < moves.count; i++){
                         if constexpr (!fast){
-                            if (best_move == moves[i]){move_ordering.emplace_back(moves[i], Evaluations::EVAL_INF); continue;}
+                            if (best_move == moves[i]){move_ordering[move_count++] = MoveOrderingStruct(moves[i], Evaluations::EVAL_INF); continue;}
                         }
-                        move_ordering.emplace_back(moves[i], getMoveImportance<fast>(board, moves[i], alpha, beta, defended_squares));
+                        move_ordering[move_count++] = MoveOrderingStruct(moves[i], getMoveImportance<fast>(board, moves[i], alpha, beta, defended_squares));
                     }
-                    std::sort(move_ordering.begin(), move_ordering.end(), [](const MoveOrderingStruct& a, const MoveOrderingStruct& b) {return a.importance > b.importance;});
+                    std::sort(move_ordering, move_ordering + move_count, [](const MoveOrderingStruct& a, const MoveOrderingStruct& b) {return a.importance > b.importance;});
                 
                     // change the moves array
                     for (int i = 0; i < moves.count; i++){
@@ -691,6 +1192,350 @@ namespace Chess{
                     }
                 }
         
+                /// @brief checks the move could be played in this position without generating moves. doesnt check pins, checks or sliding pieces being blocked
+                /// @param board 
+                /// @param move 
+                /// @return 
+                template<Colour turn>
+                bool isPseudoLegal(Board& board, Move move){
+                    if (!move) return false;
+
+                    Piece piece    = board.getPieceAt(Moves::from(move));
+                    Piece captured = board.getPieceAt(Moves::to  (move));
+
+                    if (piece == Pieces::EMPTY || Pieces::getColour(piece) != turn) return false;
+                    if (captured != Pieces::EMPTY && (Pieces::getColour(captured) == turn || Pieces::typeOf(captured) == Pieces::W_KING)) return false;
+                    if (Moves::isPromotion(move) && Pieces::typeOf(piece) != Pieces::W_PAWN) return false;
+                    if ((Moves::castling<true>(move) || Moves::castling<false>(move)) && Pieces::typeOf(piece) != Pieces::W_KING) return false;
+
+                    return true;
+                }
+
+                /// @brief returns the piece type captured by move, Pieces::EMPTY if its not a capture. includes en passant
+                /// @param board 
+                /// @param move 
+                /// @return 
+                Piece getCapturedType(Board& board, Move move){
+                    Square to = Moves::to(move);
+                    if (board.ep && to == board.ep && Pieces::typeOf(board.getPieceAt(Moves::from(move))) == Pieces::W_PAWN){
+                        return Pieces::W_PAWN;
+                    }
+                    return Pieces::typeOf(board.getPieceAt(to));
+                }
+
+                /// @brief returns true if the move isnt a capture or a queen promotion
+                /// @param board 
+                /// @param move 
+                /// @return 
+                bool isQuiet(Board& board, Move move){
+                    return getCapturedType(board, move) == Pieces::EMPTY && !(Moves::isPromotion(move) && Moves::promotionPiece(move) == Pieces::W_QUEEN);
+                }
+
+                /// @brief most valuable victim - least valuable attacker. higher for taking bigger pieces with smaller pieces
+                /// @param board 
+                /// @param move 
+                /// @return 
+                Evaluation getMVVLVA(Board& board, Move move){
+                    Piece captured = getCapturedType(board, move);
+                    Piece attacker = Pieces::typeOf(board.getPieceAt(Moves::from(move)));
+
+                    Evaluation victim_value = captured ? Values::Eval::PIECE_MG_VALUES[captured - 1] : 0;
+                    if (Moves::isPromotion(move)){
+                        victim_value += Values::Eval::PIECE_MG_VALUES[Moves::promotionPiece(move) - 1];
+                    }
+                    return victim_value * 8 - attacker;
+                }
+
+                /// @brief returns the score used to order a move without playing it
+                /// @param board 
+                /// @param move 
+                /// @param tt_move the best move saved in the transposition table
+                /// @return 
+                template<Colour turn>
+                Evaluation getMoveScore(Board& board, Move move, Move tt_move, Move countermove, int continuation_indexes[2]){
+                    if (move == tt_move) return Values::MoveOrdering::TT_MOVE_SCORE;
+
+                    if (!isQuiet(board, move)) return Values::MoveOrdering::CAPTURE_SCORE + getCaptureScore(board, move);
+
+                    if (ply < Evaluations::MAX_PLY){
+                        if (move == killers[ply][0]) return Values::MoveOrdering::KILLER_SCORE + 1;
+                        if (move == killers[ply][1]) return Values::MoveOrdering::KILLER_SCORE;
+                    }
+
+                    if (move == countermove) return Values::MoveOrdering::COUNTERMOVE_SCORE;
+
+                    Evaluation score = getHistoryScore<turn>(move);
+                    int piece_index = getContinuationPieceIndex(board, move);
+                    for (int i = 0; i < 2; i++){
+                        if (continuation_indexes[i] >= 0){
+                            score += Values::MoveOrdering::CONTINUATION_SCALE * continuation_history[i][continuation_indexes[i] + piece_index];
+                        }
+                    }
+                    return score;
+                }
+
+                /// @brief sorts the moves by the tt move, then captures by mvv-lva, then killer moves, the countermove, then quiet moves by their history and continuation history
+                /// @param board 
+                /// @param moves 
+                /// @param tt_move 
+                template<Colour turn>
+                void orderMoves(Board& board, LegalMovesArray& moves, Move tt_move){
+                    Move countermove = getCountermove(board);
+                    int continuation_indexes[2] = {getContinuationIndex(board, 1), getContinuationIndex(board, 2)};
+
+                    Evaluation scores[std::size(moves.moves)];
+                    for (int i = 0; i < moves.count; i++){
+                        scores[i] = getMoveScore<turn>(board, moves[i], tt_move, countermove, continuation_indexes);
+                    }
+
+                    sortByScores(moves, scores);
+                }
+
+                /// @brief sorts tactical moves by mvv-lva and capture history without playing them
+                /// @param board 
+                /// @param moves 
+                /// @param tt_move searched first
+                template<Colour turn>
+                void orderCaptures(Board& board, LegalMovesArray& moves, Move tt_move){
+                    Evaluation scores[std::size(moves.moves)];
+                    for (int i = 0; i < moves.count; i++){
+                        if (moves[i] == tt_move){
+                            scores[i] = Values::MoveOrdering::TT_MOVE_SCORE;
+                            continue;
+                        }
+                        scores[i] = isQuiet(board, moves[i]) ? getHistoryScore<turn>(moves[i]) : Values::MoveOrdering::CAPTURE_SCORE + getCaptureScore(board, moves[i]);
+                    }
+
+                    sortByScores(moves, scores);
+                }
+
+                /// @brief sorts the moves from highest to lowest score
+                /// @param moves 
+                /// @param scores scores[i] is the score of moves[i]
+                void sortByScores(LegalMovesArray& moves, Evaluation* scores){
+                    // insertion sort as there arent many moves
+                    for (int i = 1; i < moves.count; i++){
+                        Move move = moves.moves[i];
+                        Evaluation score = scores[i];
+                        int j = i - 1;
+                        while (j >= 0 && scores[j] < score){
+                            moves.moves[j + 1] = moves.moves[j];
+                            scores[j + 1] = scores[j];
+                            j--;
+                        }
+                        moves.moves[j + 1] = move;
+                        scores[j + 1] = score;
+                    }
+                }
+
+                /// @brief mvv-lva plus the capture history of the move
+                /// @param board 
+                /// @param move 
+                /// @return 
+                Evaluation getCaptureScore(Board& board, Move move){
+                    return getMVVLVA(board, move) + getCaptureHistory(board, move) / Values::MoveOrdering::CAPTURE_HISTORY_DIVISOR;
+                }
+
+                int& getCaptureHistory(Board& board, Move move){
+                    return capture_history[board.getPieceAt(Moves::from(move))][Moves::to(move)][getCapturedType(board, move)];
+                }
+
+                /// @brief raises the capture history of the move which caused a cutoff and lowers the captures searched before it
+                /// @param board 
+                /// @param move the move which caused a beta cutoff
+                /// @param captures_searched 
+                /// @param capture_count 
+                /// @param bonus 
+                void updateCaptureHistory(Board& board, Move move, Move* captures_searched, int capture_count, int bonus){
+                    bonus = std::min(bonus, Values::MoveOrdering::CAPTURE_HISTORY_MAX_BONUS);
+                    addGravityHistory(getCaptureHistory(board, move), bonus, Values::MoveOrdering::CAPTURE_HISTORY_MAX);
+                    for (int i = 0; i < capture_count; i++){
+                        if (isQuiet(board, captures_searched[i])) continue;
+                        addGravityHistory(getCaptureHistory(board, captures_searched[i]), -bonus, Values::MoveOrdering::CAPTURE_HISTORY_MAX);
+                    }
+                }
+
+                /// @brief relative history, how often the move causes a beta cutoff compared to how often its searched
+                /// @param move 
+                /// @return 
+                template<Colour turn>
+                Evaluation getHistoryScore(Move move){
+                    Square from = Moves::from(move);
+                    Square to   = Moves::to  (move);
+                    return Values::MoveOrdering::HISTORY_SCALE * history[turn][from][to] / (butterfly[turn][from][to] + 1);
+                }
+
+                void addKiller(Move move){
+                    if (ply >= Evaluations::MAX_PLY) return;
+                    if (killers[ply][0] != move){
+                        killers[ply][1] = killers[ply][0];
+                        killers[ply][0] = move;
+                    }
+                }
+
+                template<Colour turn>
+                void addHistory(Move move, Depth depth){
+                    int& h = history[turn][Moves::from(move)][Moves::to(move)];
+                    h += depth * depth;
+                    if (h > Values::MoveOrdering::HISTORY_MAX) ageHistory();
+                }
+
+                template<Colour turn>
+                void addButterfly(Move move, Depth depth){
+                    int& b = butterfly[turn][Moves::from(move)][Moves::to(move)];
+                    b += depth * depth;
+                    if (b > Values::MoveOrdering::HISTORY_MAX) ageHistory();
+                }
+
+                /// @brief how much to reduce a late quiet move by. from the LMR table, adjusted by the node and the moves history
+                /// @param board 
+                /// @param move 
+                /// @param depth 
+                /// @param move_index 
+                /// @param pv_node 
+                /// @param improving whether the static eval is higher than 2 plies ago
+                /// @param tt_move_capture whether the best move from the transposition table is a capture, so quiet moves are less likely to be best
+                /// @return 
+                template<Colour turn>
+                Depth getReduction(Board& board, Move move, Depth depth, int move_index, bool pv_node, bool improving, bool tt_move_capture){
+                    Depth reduction = LMR::reductions[pv_node][std::min(depth, 63)][std::min(move_index, 63)];
+
+                    if (!improving)      reduction++;
+                    if (tt_move_capture) reduction++;
+
+                    // reduce moves with good history less and bad history more
+                    reduction -= getContinuationHistory(board, move) / LMR::history_divisor;
+
+                    // always search at least 1 ply
+                    return std::clamp(reduction, 0, depth - 2);
+                }
+
+                /// @brief the continuation history of a quiet move from the moves 1 and 2 plies ago added together
+                /// @param board 
+                /// @param move 
+                /// @return 
+                int getContinuationHistory(Board& board, Move move){
+                    int history = 0;
+                    int piece_index = getContinuationPieceIndex(board, move);
+                    for (int i = 0; i < 2; i++){
+                        int index = getContinuationIndex(board, i + 1);
+                        if (index >= 0) history += continuation_history[i][index + piece_index];
+                    }
+                    return history;
+                }
+
+                /// @brief how many moves are searched before late move pruning skips the remaining quiet moves
+                /// @param depth 
+                /// @param improving 
+                /// @return 
+                int getLateMoveCount(Depth depth, bool improving){
+                    int count = Values::Negamax::LATE_MOVE_PRUNING_BASE + depth * depth;
+                    return improving ? count : count / 2;
+                }
+
+                /// @brief whether the static eval is higher than it was for this side 2 plies ago
+                /// @param static_eval 
+                /// @return 
+                bool isImproving(Evaluation static_eval){
+                    if (static_eval == Evaluations::NO_EVAL) return false;
+                    if (ply < 2 || ply - 2 >= Evaluations::MAX_PLY) return true;
+                    if (static_evals[ply - 2] == Evaluations::NO_EVAL) return true;
+                    return static_eval > static_evals[ply - 2];
+                }
+
+                /// @brief returns the move played plies_back plies ago, nullptr if it doesnt exist or a null move was played in between
+                /// @param board 
+                /// @param plies_back 
+                /// @return 
+                const UndoMoveInfo* getPreviousMove(Board& board, int plies_back){
+                    if ((int)board.move_stack.size() < plies_back) return nullptr;
+                    for (int i = 1; i <= plies_back; i++){
+                        if (ply - i >= 0 && ply - i < Evaluations::MAX_PLY && null_move[ply - i]) return nullptr;
+                    }
+                    return &board.move_stack[board.move_stack.size() - plies_back];
+                }
+
+                /// @brief returns the start of the continuation history for the move plies_back plies ago, -1 if there isnt one
+                /// @param board 
+                /// @param plies_back 
+                /// @return 
+                int getContinuationIndex(Board& board, int plies_back){
+                    const UndoMoveInfo* previous = getPreviousMove(board, plies_back);
+                    if (!previous) return -1;
+                    return ((Pieces::typeOf(previous->moved) - 1) * 64 + Moves::to(previous->move)) * 6 * 64;
+                }
+
+                /// @brief index of the move in a continuation history, added to getContinuationIndex
+                /// @param board 
+                /// @param move 
+                /// @return 
+                int getContinuationPieceIndex(Board& board, Move move){
+                    return (Pieces::typeOf(board.getPieceAt(Moves::from(move))) - 1) * 64 + Moves::to(move);
+                }
+
+                Move getCountermove(Board& board){
+                    const UndoMoveInfo* previous = getPreviousMove(board, 1);
+                    if (!previous) return 0;
+                    return countermoves[previous->moved][Moves::to(previous->move)];
+                }
+
+                void addCountermove(Board& board, Move move){
+                    const UndoMoveInfo* previous = getPreviousMove(board, 1);
+                    if (!previous) return;
+                    countermoves[previous->moved][Moves::to(previous->move)] = move;
+                }
+
+                /// @brief raises the continuation history of the move which caused a cutoff and lowers the quiet moves searched before it
+                /// @param board 
+                /// @param move the move which caused a beta cutoff
+                /// @param quiets_searched 
+                /// @param quiet_count 
+                /// @param depth 
+                void updateContinuationHistory(Board& board, Move move, Move* quiets_searched, int quiet_count, Depth depth){
+                    int bonus = std::min(depth * depth, Values::MoveOrdering::CONTINUATION_MAX_BONUS);
+                    for (int i = 0; i < 2; i++){
+                        int index = getContinuationIndex(board, i + 1);
+                        if (index < 0) continue;
+
+                        addGravityHistory(continuation_history[i][index + getContinuationPieceIndex(board, move)], bonus, Values::MoveOrdering::CONTINUATION_MAX);
+                        for (int j = 0; j < quiet_count; j++){
+                            addGravityHistory(continuation_history[i][index + getContinuationPieceIndex(board, quiets_searched[j])], -bonus, Values::MoveOrdering::CONTINUATION_MAX);
+                        }
+                    }
+                }
+
+                /// @brief adds the bonus, scaled down as the value gets closer to max so it stays between -max and max
+                /// @param value 
+                /// @param bonus 
+                /// @param max 
+                void addGravityHistory(int& value, int bonus, int max){
+                    value += bonus - value * std::abs(bonus) / max;
+                }
+
+                void clearKillers(){
+                    for (int i = 0; i < Evaluations::MAX_PLY; i++){
+                        killers[i][0] = 0;
+                        killers[i][1] = 0;
+                    }
+                }
+
+                /// @brief halves the history and butterfly tables so newer results matter more
+                void ageHistory(){
+                    for (int c = 0; c < 2; c++){
+                        for (int from = 0; from < 64; from++){
+                            for (int to = 0; to < 64; to++){
+                                history  [c][from][to] /= 2;
+                                butterfly[c][from][to] /= 2;
+                            }
+                        }
+                    }
+                    for (int i = 0; i < 2; i++){
+                        for (int& value : continuation_history[i]){
+                            value /= 2;
+                        }
+                    }
+                }
+        
                 template<bool normalised>
                 double getGamePhase(Board& board){
                     double piece_count = std::min(24, 1 * Bitboards::countBits(board.pieces[Pieces::W_KNIGHT] | board.pieces[Pieces::B_KNIGHT] | board.pieces[Pieces::W_BISHOP] | board.pieces[Pieces::B_BISHOP]) +
@@ -703,101 +1548,378 @@ namespace Chess{
                 }
 
 
-                std::string getPrincipalVariation(Board& board, Move move){
-                    std::string r = "";
+                /// @brief the principal variation from the root pv table, or just the move if the table doesnt start with it
+                /// @param move the best move
+                /// @return 
+                std::string getPrincipalVariation(Move move){
+                    if (pv_length[0] == 0 || pv_table[0][0] != move){
+                        return Visuals::moveToString(move) + " ";
+                    }
 
-                    int i = 0;
-                    while (i < 20){
-                        r += Visuals::moveToString(move);
+                    std::string r = "";
+                    for (int i = 0; i < pv_length[0]; i++){
+                        r += Visuals::moveToString(pv_table[0][i]);
                         r += " ";
-                        i++;
-                        board.playMove(move);
-                        TT::TTData entry = TT::getEntry(board.hash);
-                        if (entry.hash == board.hash){
-                            move = entry.move;
+                    }
+                    return r;
+                }
+
+                /// @brief the move expected in reply to move, from the root pv table. 0 if there isnt one
+                /// @param move the best move
+                /// @return 
+                Move getPonderMove(Move move){
+                    if (pv_length[0] >= 2 && pv_table[0][0] == move) return pv_table[0][1];
+                    return 0;
+                }
+
+                /// @brief sets the pv at this ply to move followed by the pv of the child node
+                /// @param move 
+                void updatePV(Move move){
+                    if (ply + 1 >= Evaluations::MAX_PLY) return;
+
+                    pv_table[ply][0] = move;
+                    for (int i = 0; i < pv_length[ply + 1]; i++){
+                        pv_table[ply][i + 1] = pv_table[ply + 1][i];
+                    }
+                    pv_length[ply] = pv_length[ply + 1] + 1;
+                }
+
+
+                /// @brief stops the search if the node limit or the hard time limit has been reached. the clock is only read every Values::Time::CHECK_NODES nodes
+                void checkLimits(){
+                    if (node_limit && getNodesSearched() >= node_limit) stop_search = true;
+                    if ((nodes_searched & (Values::Time::CHECK_NODES - 1)) == 0 && !pondering && time_manager.hardLimitReached()) stop_search = true;
+                }
+
+                /// @brief stops the current search
+                void stopSearch(){
+                    stop_search = true;
+                    stopHelpers();
+                }
+
+                /// @brief starts thread_count - 1 helper threads searching the board. they share results with this thread through the transposition table
+                /// @param board 
+                /// @param search_limits 
+                template<Colour turn>
+                void startHelpers(Board& board, SearchLimit search_limits){
+                    defer_moves = thread_count > 1 && smp_mode == Values::SMP::ABDADA;
+
+                    prepareHelpers();
+                    for (int i = 0; i < thread_count - 1; i++){
+                        Engine& helper = *helpers[i];
+                        helper.defer_moves = defer_moves;
+                        helper_threads.emplace_back(&Engine::helperSearch<turn>, &helper, board, search_limits.depth ? search_limits.depth : 99, i + 1);
+                    }
+                }
+
+                /// @brief makes sure there are thread_count - 1 helpers and resets them for a new search, before their threads start
+                void prepareHelpers(){
+                    while ((int)helpers.size() < thread_count - 1){
+                        helpers.emplace_back(std::make_unique<Engine>());
+                    }
+
+                    for (int i = 0; i < thread_count - 1; i++){
+                        helpers[i]->stop_search = false;
+                        helpers[i]->nodes_searched = 0; // so the last search isnt counted
+                        helpers[i]->move_ordering_mode = move_ordering_mode;
+                        helpers[i]->search_moves = search_moves;
+                    }
+                }
+
+                /// @brief stops and waits for the helper threads
+                void stopHelpers(){
+                    for (std::unique_ptr<Engine>& helper : helpers){
+                        helper->stop_search = true;
+                    }
+                    for (std::thread& helper_thread : helper_threads){
+                        if (helper_thread.joinable()) helper_thread.join();
+                    }
+                    helper_threads.clear();
+                }
+
+                /// @brief iterative deepening for a helper thread. the results are only used through the transposition table
+                /// @param board a copy of the board being searched
+                /// @param max_depth 
+                /// @param thread_id 
+                template<Colour turn>
+                void helperSearch(Board board, Depth max_depth, int thread_id){
+                    nodes_searched = 0;
+                    ab_prune_count = 0;
+                    tt_use_count   = 0;
+                    movegen_count       = 0;
+                    movegen_saved_count = 0;
+
+                    ply = 0;
+                    clearKillers();
+                    ageHistory();
+                    reserveMoveStack(board);
+
+                    [[maybe_unused]] Debug::NoAllocations no_allocations;
+
+                    // odd threads start a depth ahead so the threads are spread over different depths
+                    for (Depth depth = 1 + (thread_id & 1); depth <= max_depth && !stop_search; depth++){
+                        negamax<turn>(board, depth, -Evaluations::EVAL_MATE, Evaluations::EVAL_MATE);
+                    }
+                }
+
+                /// @brief monte carlo tree search, used by go instead of getBestMove when search_mode is Values::SearchMode::MCTS.
+                /// stops at the time or node limit, or when a playout reaches the depth limit. leaves stop being expanded once the node pool is full
+                /// @param board 
+                /// @param search_limits 
+                /// @param print whether to print info lines and the visits of each root move
+                /// @return the most visited root move
+                template<Colour turn>
+                Move getBestMoveMCTS(Board& board, SearchLimit search_limits, bool print = false){
+                    time_manager.start(search_limits, turn);
+
+                    node_limit     = search_limits.nodes;
+                    nodes_searched = 0;
+                    ab_prune_count = 0;
+                    tt_use_count   = 0;
+                    movegen_count       = 0;
+                    movegen_saved_count = 0;
+
+                    ply = 0;
+                    clearKillers();
+                    ageHistory();
+                    ponder_move = 0;
+                    reserveMoveStack(board);
+
+                    if (mcts_tree.getSizeMB() != Values::MCTS::HASH_MB) mcts_tree.resize(Values::MCTS::HASH_MB);
+                    mcts_tree.clear();
+
+                    // tree parallelism, every thread searches the same tree
+                    prepareHelpers();
+                    for (int i = 0; i < thread_count - 1; i++){
+                        Engine& helper = *helpers[i];
+                        helper.mcts_leaf = mcts_leaf;
+                        helper_threads.emplace_back(&Engine::helperSearchMCTS, &helper, board, &mcts_tree);
+                    }
+
+                    Depth max_depth = search_limits.depth ? search_limits.depth : Evaluations::MAX_PLY;
+                    Depth seldepth = 0;
+                    uint64_t depth_sum = 0;
+                    uint64_t playouts  = 0;
+                    int last_info = 0;
+
+                    while (!stop_search){
+                        Depth playout_depth;
+                        {
+                            [[maybe_unused]] Debug::NoAllocations no_allocations;
+                            playout_depth = playoutMCTS(board, mcts_tree);
                         }
-                        if (move_gen.isLegalMove(board, move)){
-                            continue;
+                        seldepth = std::max(seldepth, playout_depth);
+                        depth_sum += playout_depth;
+                        playouts++;
+
+                        // once the pool is full the tree stops growing, so a depth limit might never be reached
+                        if (seldepth >= max_depth || (search_limits.depth && mcts_tree.full())) break;
+                        if (!pondering && time_manager.softLimitReached()) break;
+
+                        if (print && time_manager.elapsed() - last_info >= Values::MCTS::INFO_INTERVAL){
+                            last_info = time_manager.elapsed();
+                            std::string info_str = getInfoStringMCTS<turn>(depth_sum / playouts, seldepth);
+                            Logger::log(info_str);
+                            std::cout << info_str << std::flush;
                         }
-                        break;
                     }
 
-                    for (int j = 0; j < i; j++){
-                        board.undoMove();
+                    stopSearch();
+
+                    MCTS::Node* best = mcts_tree.getMostVisited(mcts_tree.root());
+                    if (!best){
+                        // not a single playout finished
+                        return move_gen.generateLegalMoves<turn>(board)[0];
+                    }
+                    MCTS::Node* reply = mcts_tree.getMostVisited(*best);
+                    ponder_move = reply ? reply->move : 0;
+
+                    std::string info_str = getInfoStringMCTS<turn>(playouts ? depth_sum / playouts : 0, seldepth);
+                    Logger::log(info_str);
+                    if (print){
+                        std::cout << info_str;
+                        MCTS::Node& root = mcts_tree.root();
+                        for (int i = 0; i < root.child_count; i++){
+                            MCTS::Node& child = mcts_tree.get(root.first_child + i);
+                            if (!child.visits) continue;
+                            std::cout << "info string move " << Visuals::moveToString(child.move) <<
+                                         " visits "   << child.visits <<
+                                         " share "    << (double)child.visits / root.visits <<
+                                         " prior "    << child.prior <<
+                                         " score cp " << (int)Evaluations::normalise(MCTS::evalFromValue(child.getValue()), turn) << '\n';
+                        }
+                        std::cout << std::flush;
                     }
 
-                    return r;
+                    return best->move;
                 }
 
+                /// @brief playouts on a helper thread until it is stopped
+                /// @param board a copy of the board being searched
+                /// @param tree the tree of the engine that started the search
+                void helperSearchMCTS(Board board, MCTS::Tree* tree){
+                    nodes_searched = 0;
+                    ply = 0;
+                    clearKillers();
+                    ageHistory();
+                    reserveMoveStack(board);
+
+                    [[maybe_unused]] Debug::NoAllocations no_allocations;
 
-                /// @brief waits some time then sets stop search to true
-                /// @param time 
-                void startSearchTimer(int milliseconds){
-                    // not a good way of doing it but should work
-                    auto start = std::chrono::high_resolution_clock::now() + std::chrono::milliseconds(milliseconds);
                     while (!stop_search){
-                        auto end = std::chrono::high_resolution_clock::now();
-                        std::chrono::duration<double> d = end - start;
-                        if (d.count() >= 0){
+                        playoutMCTS(board, *tree);
+                    }
+                }
+
+                /// @brief walks down the tree by PUCT from the root to a leaf, expands and values the leaf and adds its value to every node on the way
+                /// @param board the root position, the same position again after
+                /// @param tree 
+                /// @return the length of the playout
+                Depth playoutMCTS(Board& board, MCTS::Tree& tree){
+                    MCTS::Node* path[Evaluations::MAX_PLY];
+                    int length = 0;
+
+                    MCTS::Node* node = &tree.root();
+                    path[length++] = node;
+
+                    float value; // for the side to move at the end of the path
+                    while (true){
+                        uint8_t state = node->state.load(std::memory_order_acquire);
+                        if (state == MCTS::NodeStates::CHECKMATE){
+                            value = -1;
+                            break;
+                        }
+                        if (state == MCTS::NodeStates::STALEMATE){
+                            value = 0;
+                            break;
+                        }
+                        if (length > 1 && (board.repeated() || board.insufficientMaterial())){
+                            value = 0;
+                            break;
+                        }
+                        if (state != MCTS::NodeStates::EXPANDED || length == Evaluations::MAX_PLY){
+                            value = (board.turn == Colours::WHITE) ? expandMCTS<Colours::WHITE>(board, tree, *node) : expandMCTS<Colours::BLACK>(board, tree, *node);
                             break;
                         }
-                        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+                        node = &tree.select(*node);
+                        board.playMove(node->move);
+                        path[length++] = node;
                     }
-                    stop_search = true;
-                }
 
-                /// @brief stops the current search
-                void stopSearch(std::thread& timer_thread){
-                    stop_search = true;
-                    if (timer_thread.joinable()) timer_thread.join();
-                }
+                    // a leaf valued after the search was stopped has a meaningless value
+                    if (stop_search) tree.revertVirtualLoss(path, length);
+                    else             tree.backpropagate(path, length, value);
 
-                /// @brief gets the time (milliseconds) that the search should go on for
-                /// @param s 
-                /// @return 
-                template<Colour c>
-                int getSearchTime(SearchLimit s){
-                    int t = 0;
-                    if (s.time) t = s.time;
-                    // if using wtime, winc / btime, binc
-                    // the time used is 1/20 of the time left + the inc it has
-                    // if the above is less than the time it has left, use the time it has left
+                    for (int i = 1; i < length; i++){
+                        board.undoMove();
+                    }
 
-                    // subtract lichess ping from the time it has and the time it uses
-                    // subtracting from the time it has simulates the time it takes to reach this point
-                    // subtracting from the time it uses simulates the time it takes to get to lichess/output
-                    else if (c == Colours::WHITE) t = getSearchTime(s.wtime, s.winc);
-                    else if (c == Colours::BLACK) t = getSearchTime(s.btime, s.binc);
-                    // if theres either a s.wtime s.btime s.winc or s.binc then make it at least 1 ms
-                    if (s.wtime || s.btime || s.winc || s.binc) t = std::max(1, t);
-                    if (!t) return 3600000; // if no time is set, cap it to an hour
-                    return t;
+                    return length - 1;
                 }
 
-                int getSearchTime(int time, int inc){
+                /// @brief adds the children of a leaf, unless another thread is already doing it or the pool is full, and values it.
+                /// priors are a softmax over getPriorScore, so they only depend on the position
+                /// @param board 
+                /// @param tree 
+                /// @param node the leaf
+                /// @return the value of the leaf for the side to move
+                template<Colour turn>
+                float expandMCTS(Board& board, MCTS::Tree& tree, MCTS::Node& node){
+                    uint8_t expected = MCTS::NodeStates::UNEXPANDED;
+                    if (node.state.compare_exchange_strong(expected, MCTS::NodeStates::EXPANDING, std::memory_order_acq_rel)){
+                        LegalMovesArray moves = move_gen.generateLegalMoves<turn>(board);
+                        movegen_count++;
+
+                        if (moves.count == 0){
+                            bool mated = board.inCheck<turn>();
+                            node.state.store(mated ? MCTS::NodeStates::CHECKMATE : MCTS::NodeStates::STALEMATE, std::memory_order_release);
+                            return mated ? -1 : 0;
+                        }
 
-                    // simulate the time it takes to reach this point from when lichess changed turns
-                    time -= Lichess::ping;
+                        uint32_t first = tree.allocate(moves.count);
+                        if (first){
+                            double priors[std::size(moves.moves)];
+                            Evaluation max_score = -Evaluations::EVAL_INF;
+                            for (int i = 0; i < moves.count; i++){
+                                priors[i] = getPriorScore<turn>(board, moves[i]);
+                                max_score = std::max(max_score, priors[i]);
+                            }
 
-                    int t = 0;
+                            // subtracting the best score keeps exp from overflowing
+                            double total = 0;
+                            for (int i = 0; i < moves.count; i++){
+                                priors[i] = std::exp((priors[i] - max_score) / Values::MCTS::PRIOR_TEMPERATURE);
+                                total += priors[i];
+                            }
+                            for (int i = 0; i < moves.count; i++){
+                                tree.get(first + i).reset(moves[i], priors[i] / total);
+                            }
 
-                    if (time < 10000){
-                        t = inc + 100; // if below 10 seconds, make it use ~100ms a turn
+                            node.first_child = first;
+                            node.child_count = moves.count;
+                            node.state.store(MCTS::NodeStates::EXPANDED, std::memory_order_release);
+                        }
+                        else{
+                            // no room for the children, it stays a leaf
+                            node.state.store(MCTS::NodeStates::UNEXPANDED, std::memory_order_release);
+                        }
                     }
-                    else{
-                        t = inc + time / 20; // if above 10s, make it use 1/20th of its time remaining
+
+                    Evaluation eval = (mcts_leaf == Values::MCTS::LEAF_QSEARCH) ? qsearch<turn>(board, -Evaluations::EVAL_MATE, Evaluations::EVAL_MATE) : staticEvaluate<turn>(board);
+                    return MCTS::valueFromEval(eval);
+                }
+
+                /// @brief how good a move looks without searching it, for the tree search priors. the cheap static eval after the move,
+                /// less the material SEE says the opponent wins back
+                /// @param board 
+                /// @param move 
+                /// @return 
+                template<Colour turn>
+                Evaluation getPriorScore(Board& board, Move move){
+                    Evaluation exchange_loss = 0;
+                    if (Pieces::typeOf(board.getPieceAt(Moves::from(move))) != Pieces::W_KING){
+                        // see starts from the material the move wins straight away, which the static eval already counts
+                        Piece captured = getCapturedType(board, move);
+                        Evaluation gain = captured ? getSEEValue(captured) : 0;
+                        if (Moves::isPromotion(move)) gain += getSEEValue(Moves::promotionPiece(move)) - getSEEValue(Pieces::W_PAWN);
+                        exchange_loss = see(board, move) - gain;
                     }
 
-                    // cap the time used to time so it doesnt flag
-                    t = std::min(time, t);
+                    board.playMove(move);
+                    Evaluation eval = -fastStaticEvaluate<!turn>(board);
+                    board.undoMove();
 
-                    // simulate the time it will take for it to go from here to lichess
-                    t -= Lichess::ping;
+                    return eval + exchange_loss;
+                }
 
-                    // make the time at least 0s
-                    t = std::max(0, t);
+                /// @brief the uci info line for the tree search so far. the score and pv follow the most visited moves
+                /// @param depth average playout length
+                /// @param seldepth longest playout
+                /// @return 
+                template<Colour turn>
+                std::string getInfoStringMCTS(Depth depth, Depth seldepth){
+                    int time_taken = std::max(1, time_manager.elapsed());
+                    MCTS::Node& root = mcts_tree.root();
+
+                    std::string pv = "";
+                    MCTS::Node* best = mcts_tree.getMostVisited(root);
+                    Evaluation eval = best ? MCTS::evalFromValue(best->getValue()) : 0;
+                    for (MCTS::Node* node = best; node; node = mcts_tree.getMostVisited(*node)){
+                        pv += Visuals::moveToString(node->move);
+                        pv += " ";
+                    }
 
-                    return t;
+                    return std::string("info") +
+                           " depth "    + std::to_string(depth) +
+                           " seldepth " + std::to_string(seldepth) +
+                           " nodes "    + std::to_string(root.visits) +
+                           " time "     + std::to_string(time_taken) +
+                           " nps "      + std::to_string((uint64_t)root.visits * 1000 / time_taken) +
+                           " hashfull " + std::to_string(mcts_tree.getHashfull()) +
+                           " score cp " + std::to_string((int)Evaluations::normalise(eval, turn)) +
+                           " pv "       + pv +
+                           '\n';
                 }
 
             };
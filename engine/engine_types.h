@@ -2,6 +2,10 @@
 #ifndef ENGINE_TYPES_H
 #define ENGINE_TYPES_H
 
+#include <array>
+#include <cmath>
+#include <string>
+
 #include "../chess/types.h"
 
 
@@ -49,6 +53,7 @@ namespace Chess::Engine{
         constexpr Evaluation EVAL_ZERO     = 0;
         constexpr Evaluation EVAL_DRAW     = 0;
         constexpr Evaluation EVAL_INF = 1000000;
+        constexpr Evaluation NO_EVAL  = -EVAL_INF; // static eval when in check
 
         constexpr Evaluation EVAL_MATE             = 900000;
         constexpr Evaluation EVAL_MATE_IN_MAX_PLY  = EVAL_MATE - MAX_PLY;
@@ -86,6 +91,14 @@ namespace Chess::Engine{
         MoveOrderingStruct() : move(0), importance(0), raised_alpha(0) {}
     };
 
+    /// @brief a finished multipv line, kept until every line of the iteration is searched so they can be printed best first
+    struct RootLine{
+        Evaluation eval = 0;
+        Move move   = 0;
+        Move ponder = 0;
+        std::string pv = "";
+    };
+
 
     /// @brief all times are in milliseconds
     struct SearchLimit{
@@ -95,6 +108,9 @@ namespace Chess::Engine{
         int winc  = 0;
         int binc  = 0;
         int depth = 0;
+        uint64_t nodes = 0;
+        int movestogo = 0;
+        int mate = 0; // go mate, look for a mate in this many moves
     
         bool operator==(const SearchLimit& other) {
             return (
@@ -103,7 +119,10 @@ namespace Chess::Engine{
                 btime == other.btime &&
                 winc  == other.winc  &&
                 binc  == other.binc  &&
-                depth == other.depth
+                depth == other.depth &&
+                nodes == other.nodes &&
+                movestogo == other.movestogo &&
+                mate == other.mate
             );
         }
 
@@ -120,10 +139,16 @@ namespace Chess::Engine{
             os << s.binc;
             os << ", Depth: ";
             os << s.depth;
+            os << ", Nodes: ";
+            os << s.nodes;
+            os << ", MovesToGo: ";
+            os << s.movestogo;
+            os << ", Mate: ";
+            os << s.mate;
             return os;
         }
     
-        constexpr SearchLimit(int time_ = 0, int wtime_ = 0, int btime_ = 0, int winc_ = 0, int binc_ = 0, int depth_ = 0) : time(time_), wtime(wtime_), btime(btime_), winc(winc_), binc(binc_), depth(depth_) {}
+        constexpr SearchLimit(int time_ = 0, int wtime_ = 0, int btime_ = 0, int winc_ = 0, int binc_ = 0, int depth_ = 0, uint64_t nodes_ = 0) : time(time_), wtime(wtime_), btime(btime_), winc(winc_), binc(binc_), depth(depth_), nodes(nodes_) {}
     };
     
     namespace Lichess{
@@ -147,14 +172,113 @@ namespace Chess::Engine{
         } // namespace NodeTypes
 
         namespace Negamax{
-            Depth NULL_MOVE_PRUNE_REDUCTION = 3;
-            Evaluation RAZORING_DELTA = 200; // if (qsearch eval + this) < alpha, return alpha
+            Depth NULL_MOVE_PRUNE_REDUCTION = 3; // base reduction of the null move search
+            Depth NULL_MOVE_MIN_DEPTH = 2;
+            Depth NULL_MOVE_DEPTH_DIVISOR = 4; // the reduction grows by 1 every NULL_MOVE_DEPTH_DIVISOR plies of depth
+            Evaluation NULL_MOVE_EVAL_DIVISOR = 200; // and by 1 for every NULL_MOVE_EVAL_DIVISOR the static eval is above beta
+            Depth NULL_MOVE_MAX_EVAL_REDUCTION = 3;
+            Depth NULL_MOVE_VERIFICATION_DEPTH = 12; // null move cutoffs at this depth or higher are checked with a reduced search without null moves
+            Evaluation RAZORING_DELTA = 200; // if static eval + RAZORING_DELTA * depth < alpha, return the qsearch eval if its below beta
+            Depth RAZORING_MAX_DEPTH = 3;
+
+            Evaluation REVERSE_FUTILITY_MARGIN = 80; // if static eval - REVERSE_FUTILITY_MARGIN * depth >= beta, return static eval
+            Depth REVERSE_FUTILITY_MAX_DEPTH = 6;
+
+            Evaluation FUTILITY_MARGIN = 100; // if static eval + FUTILITY_MARGIN * depth <= alpha, skip quiet moves
+            Depth FUTILITY_MAX_DEPTH = 3;
+
+            Depth IIR_MIN_DEPTH = 4; // nodes at this depth or higher without a tt move are searched 1 ply less
+
+            Depth PROBCUT_MIN_DEPTH = 5;
+            Evaluation PROBCUT_MARGIN = 200; // a capture which beats beta + PROBCUT_MARGIN in a shallow search cuts the node
+            Depth PROBCUT_REDUCTION = 4;
+
+            Depth LATE_MOVE_PRUNING_MAX_DEPTH = 6;
+            int LATE_MOVE_PRUNING_BASE = 3; // quiet moves after the first (LATE_MOVE_PRUNING_BASE + depth * depth) moves are skipped, half as many when not improving
+
+            Depth HISTORY_PRUNING_MAX_DEPTH = 3;
+            int HISTORY_PRUNING_MARGIN = 4000; // quiet moves with continuation history below -HISTORY_PRUNING_MARGIN * depth are skipped
         } // namespace search
 
         namespace QSearch{
-            Evaluation BIG_DELTA = 200;
+            Evaluation BIG_DELTA = 200; // skip captures where standing pat + captured value + BIG_DELTA < alpha
+            Evaluation SEE_KING_VALUE = 20000;
+            Depth TT_DEPTH = 0; // depth qsearch results are saved to the transposition table with, below any negamax entry
         } // namespace QSEARCH
 
+        namespace MoveOrdering{
+            int HISTORY = 0; // tt move, mvv-lva captures, killer moves then history. doesnt play any moves
+            int EVAL    = 1; // evaluates the board after every move (qsearch at higher depths). slow, kept for comparing
+
+            Evaluation TT_MOVE_SCORE = 4000000;
+            Evaluation CAPTURE_SCORE = 3000000; // + mvv-lva
+            Evaluation KILLER_SCORE  = 2000000;
+            Evaluation COUNTERMOVE_SCORE = 1999999;
+            Evaluation HISTORY_SCALE = 1000000; // quiet moves are ordered by history / butterfly * HISTORY_SCALE
+            Evaluation CONTINUATION_SCALE = 16; // + continuation history * CONTINUATION_SCALE for 1 and 2 plies back
+
+            int HISTORY_MAX = 1 << 24; // halve the history tables when a value goes above this
+
+            constexpr int CONTINUATION_SIZE = 6 * 64 * 6 * 64;
+            int CONTINUATION_MAX = 16384; // continuation history stays between -CONTINUATION_MAX and CONTINUATION_MAX
+            int CONTINUATION_MAX_BONUS = 1200;
+
+            int CAPTURE_HISTORY_MAX = 16384;
+            int CAPTURE_HISTORY_MAX_BONUS = 1200;
+            int CAPTURE_HISTORY_DIVISOR = 32; // captures are ordered by mvv-lva + capture history / CAPTURE_HISTORY_DIVISOR
+            int QSEARCH_CAPTURE_BONUS = 256;  // capture history bonus for a cutoff in qsearch, which has no depth. the bonus of a depth 16 cutoff in negamax
+        } // namespace MoveOrdering
+
+        namespace Time{
+            uint64_t CHECK_NODES = 1024;    // nodes between checking the clock, must be a power of 2
+            int MOVES_TO_GO = 20;           // moves assumed to be left when playing without movestogo
+            int HARD_LIMIT_SCALE = 3;       // the hard limit is at most this times the soft limit
+            int HARD_LIMIT_CLOCK_FRACTION = 4; // and at most 1/this of the time left
+        } // namespace Time
+
+        namespace Aspiration{
+            Depth MIN_DEPTH = 4;         // depths below this are searched with a full window
+            Evaluation START_DELTA = 25; // distance from the previous eval to each side of the first window
+        } // namespace Aspiration
+
+        namespace RootSearch{
+            int PVS  = 0; // aspiration windows around the previous eval
+            int MTDF = 1; // zero window searches which narrow the bounds on the eval until they meet
+
+            Evaluation MTDF_RESOLUTION = 1; // mtd(f) stops when the bounds are this close
+        } // namespace RootSearch
+
+        namespace SMP{
+            int LAZY_SMP = 0; // threads share the transposition table
+            int ABDADA   = 1; // threads share the transposition table and defer moves another thread is searching
+
+            Depth ABDADA_DEFER_DEPTH = 3; // only defer moves at nodes with at least this depth
+        } // namespace SMP
+
+        namespace SearchMode{
+            int ALPHA_BETA = 0; // iterative deepening negamax
+            int MCTS       = 1; // PUCT tree search, engine/mcts.h
+        } // namespace SearchMode
+
+        namespace MCTS{
+            int LEAF_QSEARCH = 0; // leaves are valued with qsearch
+            int LEAF_STATIC  = 1; // leaves are valued with the static eval
+
+            int HASH_MB = 64; // size of the node pool
+
+            double EXPLORATION       = 1.5;  // c in the PUCT formula, higher searches moves with fewer visits more
+            double PRIOR_TEMPERATURE = 50;   // priors are proportional to exp(getPriorScore / PRIOR_TEMPERATURE), lower makes them sharper
+            double FPU_REDUCTION     = 0.2;  // moves without visits are valued as the parents value minus FPU_REDUCTION
+            double EVAL_SCALE        = 400;  // value = tanh(eval / EVAL_SCALE)
+            int VIRTUAL_LOSS     = 3;    // losses added to a node while a thread is searching below it, so other threads pick different nodes
+
+            int INFO_INTERVAL = 1000; // ms between info lines
+        } // namespace MCTS
+
+        namespace MateSolver{
+            int HASH_MB = 16; // size of the proof number table, separate from the transposition table
+        } // namespace MateSolver
+
         // evaluations for specific things
         namespace Eval{
             Evaluation PIECE_MG_VALUES[6] = {62, 337, 365, 477, 1025, 0};
@@ -760,16 +884,31 @@ namespace Chess::Engine{
     } // namespace Values
 
     namespace LMR{
-        Depth reduction = 2;
         Depth min_depth = 3;
-        int moves = 5;
-
-        Depth getLMRDepth(Depth depth){
-            return std::max(std::min(min_depth, depth),
-                            (0 < 8) ?
-                            (depth - reduction) :
-                            std::max(8 - reduction, (depth - 2 * reduction)));
+        int moves = 3;          // the first moves are never reduced
+        int history_divisor = 8192; // continuation history / history_divisor is taken off the reduction
+
+        double base[2]    = {0.75, 0.25}; // [pv node]
+        double divisor[2] = {2.25, 2.5};
+
+        /// @brief reductions[pv node][depth][move index] = base + log(depth) * log(move index) / divisor
+        std::array<std::array<std::array<Depth, 64>, 64>, 2> initialiseReductions(){
+            std::array<std::array<std::array<Depth, 64>, 64>, 2> r;
+            for (int pv = 0; pv < 2; pv++){
+                for (int depth = 0; depth < 64; depth++){
+                    for (int move_index = 0; move_index < 64; move_index++){
+                        if (depth == 0 || move_index == 0){
+                            r[pv][depth][move_index] = 0;
+                            continue;
+                        }
+                        r[pv][depth][move_index] = (Depth)(base[pv] + std::log(depth) * std::log(move_index) / divisor[pv]);
+                    }
+                }
+            }
+            return r;
         }
+
+        std::array<std::array<std::array<Depth, 64>, 64>, 2> reductions = initialiseReductions();
     } // namespace LMR
 
 } // namespace Chess::Engine
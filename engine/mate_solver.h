@@ -0,0 +1,259 @@
+#ifndef MATE_SOLVER_H
+#define MATE_SOLVER_H
+
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <string>
+
+#include "..\chess\types.h"
+#include "..\chess\board.h"
+#include "..\chess\move_generator.h"
+#include "..\transposition_table\zobrist.h"
+#include "engine_types.h"
+#include "time_manager.h"
+
+
+namespace Chess::Engine{
+
+    /// @brief depth first proof number search (df-pn) for go mate. the attacker only plays checking moves and the defender plays every move.
+    /// a node is proven when the attacker can force mate from it, disproven when it cant within the plies left
+    class MateSolver{
+        private:
+            static constexpr uint32_t INF = 1 << 30; // proof or disproof number of a solved node
+
+            #pragma pack(push, 1)
+            struct Entry{
+                Zobrist::Hash key; // hash mixed with the plies left, a result only holds for the plies it was searched with
+                uint32_t pn;
+                uint32_t dn;
+            };
+            #pragma pack(pop)
+
+            std::vector<Entry> table;
+            MoveGeneration move_gen;
+            Colour attacker;
+
+            uint64_t nodes = 0;
+            uint64_t node_limit = 0;
+            std::atomic_bool* stop_search = nullptr;
+            std::atomic_bool* pondering = nullptr;
+            TimeManager* time_manager = nullptr;
+
+        public:
+            void resize(int size_mb){
+                table = std::vector<Entry>(std::max<size_t>(1, (size_t)size_mb * 1024 * 1024 / sizeof(Entry)));
+            }
+
+            uint64_t getNodes(){
+                return nodes;
+            }
+
+            /// @brief looks for a mate in at most max_moves moves for the side to move, trying each amount of moves from 1 so the shortest mate is found
+            /// @param board
+            /// @param max_moves
+            /// @param stop_search_ set when the search should stop, and set by the solver when a limit is reached
+            /// @param pondering_ time limits are ignored while pondering
+            /// @param time_manager_ already started
+            /// @param node_limit_ 0 for no limit
+            /// @param print whether to print an info line for each amount of moves
+            /// @return the amount of moves in the mate, 0 if none was found. the line is in pv
+            int solve(Board& board, int max_moves, std::atomic_bool& stop_search_, std::atomic_bool& pondering_, TimeManager& time_manager_, uint64_t node_limit_, std::vector<Move>& pv, bool print){
+                if (table.empty()) resize(Values::MateSolver::HASH_MB);
+                std::fill(table.begin(), table.end(), Entry());
+
+                stop_search  = &stop_search_;
+                pondering    = &pondering_;
+                time_manager = &time_manager_;
+                node_limit   = node_limit_;
+                nodes        = 0;
+                attacker     = board.turn;
+                pv.clear();
+
+                for (int moves = 1; moves <= max_moves && !*stop_search; moves++){
+                    Depth plies = 2 * moves - 1;
+                    if (board.turn == Colours::WHITE) search<Colours::WHITE>(board, plies, INF, INF);
+                    else                              search<Colours::BLACK>(board, plies, INF, INF);
+
+                    if (*stop_search) break;
+
+                    bool proven = getEntry(board.hash, plies).pn == 0;
+                    if (print){
+                        std::string info_str = "info depth " + std::to_string(plies) + " nodes " + std::to_string(nodes) + " time " + std::to_string(time_manager->elapsed());
+                        if (proven){
+                            getProofLine(board, plies, pv);
+                            info_str += " score mate " + std::to_string(moves) + " pv";
+                            for (Move move : pv) info_str += " " + Visuals::moveToString(move);
+                        }
+                        std::cout << info_str << '\n' << std::flush;
+                    }
+                    if (proven){
+                        if (pv.empty()) getProofLine(board, plies, pv);
+                        return moves;
+                    }
+                }
+                return 0;
+            }
+
+        private:
+            /// @brief expands the node until its proof number reaches thpn or its disproof number reaches thdn, and saves its numbers
+            /// @param board
+            /// @param plies plies the attacker has left to mate in
+            /// @param thpn
+            /// @param thdn
+            template<Colour turn>
+            void search(Board& board, Depth plies, uint32_t thpn, uint32_t thdn){
+                nodes++;
+                checkLimits();
+                if (*stop_search) return;
+
+                bool or_node = turn == attacker;
+
+                // draws cant be mates. the result is saved even though a repetition depends on the path, which can only hide mates
+                if (board.repeated() || board.insufficientMaterial()){
+                    save(board.hash, plies, INF, 0);
+                    return;
+                }
+
+                LegalMovesArray moves = move_gen.generateLegalMoves<turn>(board);
+                Zobrist::Hash child_hashes[std::size(moves.moves)];
+                LegalMovesArray children;
+
+                if (moves.count == 0){
+                    // checkmate proves the node when the attacker just moved, stalemate disproves it
+                    if (!or_node && board.inCheck<turn>()) save(board.hash, plies, 0, INF);
+                    else                                   save(board.hash, plies, INF, 0);
+                    return;
+                }
+                if (plies == 0){
+                    // the defender isnt mated and the attacker has no moves left
+                    save(board.hash, plies, INF, 0);
+                    return;
+                }
+
+                for (Move move : moves){
+                    board.playMove(move);
+                    // the attacker only checks
+                    if (!or_node || board.inCheck()){
+                        child_hashes[children.count] = board.hash;
+                        children += move;
+                    }
+                    board.undoMove();
+                }
+
+                if (children.count == 0){
+                    save(board.hash, plies, INF, 0);
+                    return;
+                }
+
+                while (true){
+                    // at an or node the attacker needs 1 child proven and the defender needs every child disproven, and the other way around at an and node
+                    uint64_t sum = 0;
+                    uint32_t best = INF + 1;
+                    uint32_t second = INF + 1;
+                    int best_index = 0;
+                    for (int i = 0; i < children.count; i++){
+                        Entry child = getEntry(child_hashes[i], plies - 1);
+                        uint32_t selected = or_node ? child.pn : child.dn; // minimised over the children
+                        uint32_t summed   = or_node ? child.dn : child.pn;
+                        sum += summed;
+                        if (selected < best){
+                            second = best;
+                            best = selected;
+                            best_index = i;
+                        }
+                        else if (selected < second){
+                            second = selected;
+                        }
+                    }
+                    uint32_t summed = std::min<uint64_t>(sum, INF);
+                    uint32_t pn = or_node ? best : summed;
+                    uint32_t dn = or_node ? summed : best;
+                    pn = std::min(pn, INF);
+                    dn = std::min(dn, INF);
+
+                    if (pn >= thpn || dn >= thdn || pn == 0 || dn == 0){
+                        save(board.hash, plies, pn, dn);
+                        return;
+                    }
+
+                    // thresholds for the best child, so it returns when it stops being the best or this node passes its thresholds
+                    Entry child = getEntry(child_hashes[best_index], plies - 1);
+                    uint32_t child_thpn;
+                    uint32_t child_thdn;
+                    if (or_node){
+                        child_thpn = std::min<uint64_t>(thpn, (uint64_t)second + 1);
+                        child_thdn = std::min<uint64_t>(INF, (uint64_t)thdn - dn + child.dn);
+                    }
+                    else{
+                        child_thpn = std::min<uint64_t>(INF, (uint64_t)thpn - pn + child.pn);
+                        child_thdn = std::min<uint64_t>(thdn, (uint64_t)second + 1);
+                    }
+
+                    board.playMove(children[best_index]);
+                    search<!turn>(board, plies - 1, child_thpn, child_thdn);
+                    board.undoMove();
+
+                    if (*stop_search) return;
+                }
+            }
+
+            /// @brief the mating line from the table, following proven children. the defender plays its first proven reply
+            /// @param board
+            /// @param plies
+            /// @param pv
+            void getProofLine(Board& board, Depth plies, std::vector<Move>& pv){
+                pv.clear();
+                int played = 0;
+                while (plies > 0){
+                    LegalMovesArray moves = (board.turn == Colours::WHITE) ? move_gen.generateLegalMoves<Colours::WHITE>(board) : move_gen.generateLegalMoves<Colours::BLACK>(board);
+                    Move next = 0;
+                    for (Move move : moves){
+                        board.playMove(move);
+                        bool proven = getEntry(board.hash, plies - 1).pn == 0;
+                        board.undoMove();
+                        if (proven){
+                            next = move;
+                            break;
+                        }
+                    }
+                    if (!next) break;
+
+                    pv.emplace_back(next);
+                    board.playMove(next);
+                    played++;
+                    plies--;
+                }
+                for (int i = 0; i < played; i++) board.undoMove();
+            }
+
+            Zobrist::Hash getKey(Zobrist::Hash hash, Depth plies){
+                return hash ^ ((Zobrist::Hash)(plies + 1) * 0x9E3779B97F4A7C15ULL);
+            }
+
+            /// @brief the proof and disproof numbers saved for the position, 1 and 1 if it hasnt been searched
+            /// @param hash
+            /// @param plies
+            /// @return
+            Entry getEntry(Zobrist::Hash hash, Depth plies){
+                Zobrist::Hash key = getKey(hash, plies);
+                Entry& entry = table[key % table.size()];
+                if (entry.key == key) return entry;
+                return Entry{key, 1, 1};
+            }
+
+            void save(Zobrist::Hash hash, Depth plies, uint32_t pn, uint32_t dn){
+                Zobrist::Hash key = getKey(hash, plies);
+                table[key % table.size()] = Entry{key, pn, dn};
+            }
+
+            void checkLimits(){
+                if (node_limit && nodes >= node_limit) *stop_search = true;
+                if ((nodes & (Values::Time::CHECK_NODES - 1)) == 0 && !*pondering && time_manager->hardLimitReached()) *stop_search = true;
+            }
+    };
+
+} // namespace Chess::Engine
+
+
+#endif
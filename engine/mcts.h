@@ -0,0 +1,204 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cmath>
+
+#include "engine_types.h"
+
+
+namespace Chess::Engine::MCTS{
+
+    namespace NodeStates{
+        constexpr uint8_t UNEXPANDED = 0;
+        constexpr uint8_t EXPANDING  = 1; // a thread is adding the children
+        constexpr uint8_t EXPANDED   = 2;
+        constexpr uint8_t CHECKMATE  = 3; // the side to move has no legal moves and is in check
+        constexpr uint8_t STALEMATE  = 4;
+    } // namespace NodeStates
+
+    /// @brief a position in the tree. values are from the perspective of the side which played move, so a parent picks the child with the highest value
+    struct Node{
+        std::atomic<double>   value_sum    = 0; // double as a float stops counting small values past 2^24 visits
+        std::atomic<uint32_t> visits       = 0;
+        std::atomic<uint16_t> virtual_loss = 0; // threads currently searching below this node, times Values::MCTS::VIRTUAL_LOSS
+        std::atomic<uint8_t>  state        = NodeStates::UNEXPANDED;
+        uint8_t  child_count = 0;
+        uint32_t first_child = 0; // index of the first child in the pool, the children are next to each other
+        float prior = 0; // probability the parent would pick this move, a softmax of getPriorScore (the static eval after the move, less the SEE loss)
+        Move move = 0; // the move from the parent
+
+        /// @brief reuses the node for a new child. only called by the thread expanding the parent, before the parent is marked expanded
+        /// @param move_
+        /// @param prior_
+        void reset(Move move_, float prior_){
+            value_sum   .store(0, std::memory_order_relaxed);
+            visits      .store(0, std::memory_order_relaxed);
+            virtual_loss.store(0, std::memory_order_relaxed);
+            state       .store(NodeStates::UNEXPANDED, std::memory_order_relaxed);
+            child_count = 0;
+            first_child = 0;
+            prior = prior_;
+            move  = move_;
+        }
+
+        /// @brief the average value, 0 without visits
+        /// @return
+        float getValue(){
+            uint32_t n = visits.load(std::memory_order_relaxed);
+            return n ? value_sum.load(std::memory_order_relaxed) / n : 0;
+        }
+    };
+
+    /// @brief a value in [-1, 1] from an evaluation
+    /// @param eval
+    /// @return
+    float valueFromEval(Evaluation eval){
+        return std::tanh(eval / Values::MCTS::EVAL_SCALE);
+    }
+
+    /// @brief the evaluation a value corresponds to, the inverse of valueFromEval
+    /// @param value
+    /// @return
+    Evaluation evalFromValue(float value){
+        return Values::MCTS::EVAL_SCALE * std::atanh(std::clamp<double>(value, -0.9999, 0.9999));
+    }
+
+    /// @brief the search tree. nodes are allocated from a fixed pool which is reused every search, so the search never allocates.
+    /// threads share the tree, and virtual loss spreads them over different lines
+    class Tree{
+        private:
+            std::unique_ptr<Node[]> nodes;
+            uint32_t capacity = 0;
+            int size_mb = 0;
+            std::atomic<uint32_t> used = 0; // nodes handed out, can go a little past capacity once the pool is full
+
+        public:
+            void resize(int mb){
+                size_mb  = mb;
+                capacity = std::max<uint64_t>(1, (uint64_t)mb * 1024 * 1024 / sizeof(Node));
+                nodes    = std::make_unique<Node[]>(capacity);
+                clear();
+            }
+
+            int getSizeMB(){
+                return size_mb;
+            }
+
+            /// @brief removes every node except a fresh root
+            void clear(){
+                used = 1;
+                nodes[0].reset(0, 1);
+            }
+
+            Node& root(){
+                return nodes[0];
+            }
+
+            Node& get(uint32_t index){
+                return nodes[index];
+            }
+
+            /// @brief hands out count nodes next to each other
+            /// @param count
+            /// @return the index of the first node, 0 if the pool is full
+            uint32_t allocate(int count){
+                if (full()) return 0; // so used cant keep growing and overflow
+                uint32_t first = used.fetch_add(count, std::memory_order_relaxed);
+                if ((uint64_t)first + count > capacity) return 0;
+                return first;
+            }
+
+            bool full(){
+                return used.load(std::memory_order_relaxed) >= capacity;
+            }
+
+            /// @brief permille of the pool used, for the uci hashfull
+            /// @return
+            int getHashfull(){
+                return (uint64_t)std::min(used.load(std::memory_order_relaxed), capacity) * 1000 / capacity;
+            }
+
+            /// @brief the child with the highest PUCT score, with virtual loss added to it. parent has to be expanded
+            /// @param parent
+            /// @return
+            Node& select(Node& parent){
+                uint32_t parent_visits = parent.visits.load(std::memory_order_relaxed) + parent.virtual_loss.load(std::memory_order_relaxed);
+                double sqrt_visits = std::sqrt((double)std::max<uint32_t>(1, parent_visits));
+                // the parents value is from the other sides perspective
+                double fpu = -parent.getValue() - Values::MCTS::FPU_REDUCTION;
+
+                Node* best = &nodes[parent.first_child];
+                double best_score = -1e9;
+                for (int i = 0; i < parent.child_count; i++){
+                    Node& child = nodes[parent.first_child + i];
+                    uint32_t loss = child.virtual_loss.load(std::memory_order_relaxed);
+                    uint32_t n    = child.visits.load(std::memory_order_relaxed) + loss;
+
+                    // virtual losses count as visits with a value of -1
+                    double q = n ? (child.value_sum.load(std::memory_order_relaxed) - loss) / n : fpu;
+                    double score = q + Values::MCTS::EXPLORATION * child.prior * sqrt_visits / (1 + n);
+
+                    if (score > best_score){
+                        best_score = score;
+                        best = &child;
+                    }
+                }
+
+                best->virtual_loss.fetch_add(Values::MCTS::VIRTUAL_LOSS, std::memory_order_relaxed);
+                return *best;
+            }
+
+            /// @brief adds the value of the last node in the path to every node in it, and removes the virtual losses
+            /// @param path nodes from the root
+            /// @param length
+            /// @param value from the perspective of the side to move at the last node
+            void backpropagate(Node** path, int length, float value){
+                for (int i = length - 1; i >= 0; i--){
+                    value = -value; // the node stores it for the side which moved into it
+                    addValue(*path[i], value);
+                    path[i]->visits.fetch_add(1, std::memory_order_relaxed);
+                    if (i) path[i]->virtual_loss.fetch_sub(Values::MCTS::VIRTUAL_LOSS, std::memory_order_relaxed);
+                }
+            }
+
+            /// @brief removes the virtual losses of a path without counting it, for a playout cut short by stopping the search
+            /// @param path
+            /// @param length
+            void revertVirtualLoss(Node** path, int length){
+                for (int i = 1; i < length; i++){
+                    path[i]->virtual_loss.fetch_sub(Values::MCTS::VIRTUAL_LOSS, std::memory_order_relaxed);
+                }
+            }
+
+            /// @brief the most visited child of parent, nullptr if it hasnt been expanded or no child has been visited
+            /// @param parent
+            /// @return
+            Node* getMostVisited(Node& parent){
+                if (parent.state.load(std::memory_order_acquire) != NodeStates::EXPANDED) return nullptr;
+
+                Node* best = nullptr;
+                uint32_t best_visits = 0;
+                for (int i = 0; i < parent.child_count; i++){
+                    Node& child = nodes[parent.first_child + i];
+                    if (child.visits > best_visits){
+                        best_visits = child.visits;
+                        best = &child;
+                    }
+                }
+                return best;
+            }
+
+        private:
+            void addValue(Node& node, double value){
+                double current = node.value_sum.load(std::memory_order_relaxed);
+                while (!node.value_sum.compare_exchange_weak(current, current + value, std::memory_order_relaxed));
+            }
+    };
+
+} // namespace Chess::Engine::MCTS
+
+
+#endif
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <memory>
+#include <chrono>
 
 #include "..\chess\types.h"
 #include "..\chess\board.h"
@@ -78,15 +80,69 @@ namespace Chess{
             return puzzles;
         }
 
+        Depth BENCH_DEPTH = 10;
+
+        const std::string BENCH_FENS[] = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+            "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+            "2r3k1/pp3ppp/2n1b3/3p4/3P4/2PB1N2/P4PPP/4R1K1 b - - 0 22",
+            "r1b2rk1/2q1bppp/p2p1n2/np2p3/3PP3/5N1P/PPBN1PP1/R1BQR1K1 b - - 0 12",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+            "8/8/4k3/8/2p5/8/B2K4/8 w - - 0 1",
+            "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+        };
+
+        /// @brief searches the bench positions to a fixed depth on 1 thread with empty tables, and prints the total nodes, time and nps.
+        /// the node count only changes when the search does
+        /// @param depth 
+        /// @param root_search Values::RootSearch, to compare the root drivers
+        void bench(Depth depth = BENCH_DEPTH, int root_search = Values::RootSearch::PVS){
+            Board board;
+
+            SearchLimit search_limit;
+            search_limit.depth = depth;
+
+            uint64_t total_nodes = 0;
+            double time_taken = 0; // seconds, not counting clearing the transposition table
+
+            int i = 0;
+            for (const std::string& fen : BENCH_FENS){
+                i++;
+                TT::clear();
+                // a fresh engine for each position, so its killers and history tables dont depend on the positions before it
+                std::unique_ptr<Engine> engine = std::make_unique<Engine>();
+                engine->root_search = root_search;
+                board.setFen(fen);
+                auto start = std::chrono::high_resolution_clock::now();
+                Move best_move = engine->getBestMove(board, search_limit);
+                std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+                time_taken += duration.count();
+                total_nodes += engine->getNodesSearched();
+                std::cout << "Position " << i << "/" << std::size(BENCH_FENS) << ": " << Visuals::moveToString(best_move) << " nodes " << engine->getNodesSearched() << "    " << fen << '\n';
+            }
+
+            std::cout << "===========================\n";
+            std::cout << "Total time (ms) : " << (int)(time_taken * 1000) << '\n';
+            std::cout << "Nodes searched  : " << total_nodes << '\n';
+            std::cout << "Nodes/second    : " << (uint64_t)(total_nodes / time_taken) << '\n';
+        }
+
         /// @brief puzzle types are all the puzzle types that it will do puzzles from
         /// @param puzzle_types are the strings of puzzle types it will do. `all` does count from all types.
         /// @param lengths are the strings of lengths it will do (oneMove, short, long, veryLong, noLength). `all` will choose from all
         /// @param count is the amount of puzzles to do from each puzzle_type and length
         /// @param search_limit is the limit that the engine will search to
         /// @param print is whether it will print the results of each puzzle
-        void doTest(std::vector<std::string>& puzzle_types, std::vector<std::string>& puzzle_lengths, int count, SearchLimit search_limit, int print){
+        /// @param threads is the amount of threads the engine searches with
+        /// @param smp_mode is how the threads search together (Values::SMP)
+        void doTest(std::vector<std::string>& puzzle_types, std::vector<std::string>& puzzle_lengths, int count, SearchLimit search_limit, int print, int threads = 1, int smp_mode = Values::SMP::LAZY_SMP){
             Board board;
             Engine engine;
+            engine.thread_count = threads;
+            engine.smp_mode = smp_mode;
 
             std::string puzzle_types_str = "";
             for (std::string t : puzzle_types){
@@ -100,7 +156,7 @@ namespace Chess{
                 puzzle_lengths_str += ' ';
             }
 
-            std::cout << "Types: " << puzzle_types_str << "| Lengths: " << puzzle_lengths_str << "| Count: " << count << " | SearchLimit: " << search_limit << '\n';
+            std::cout << "Types: " << puzzle_types_str << "| Lengths: " << puzzle_lengths_str << "| Count: " << count << " | SearchLimit: " << search_limit << " | Threads: " << threads << " | SMP: " << ((smp_mode == Values::SMP::ABDADA) ? "ABDADA" : "LazySMP") << '\n';
 
             // if its correct:
             //     leave a gap before it prints (makes it easier to see wrong positions)
@@ -0,0 +1,105 @@
+#ifndef TIME_MANAGER_H
+#define TIME_MANAGER_H
+
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+
+#include "engine_types.h"
+
+
+namespace Chess::Engine{
+
+    /// @brief decides how long a search can go on for. the search checks it every Values::Time::CHECK_NODES nodes instead of a timer thread sleeping until the deadline
+    class TimeManager{
+        private:
+            std::atomic<int64_t> start_time = 0; // ms on the steady clock. atomic as ponderhit restarts it from the uci thread
+            int soft_limit = 0; // ms, dont start another iteration after this
+            int hard_limit = 0; // ms, stop the search immediately after this
+            bool limited = false;
+
+        public:
+            /// @brief starts the clock and works out the limits for the side to move
+            /// @param s
+            /// @param turn
+            void start(SearchLimit s, Colour turn){
+                start_time = now();
+
+                int time = (turn == Colours::WHITE) ? s.wtime : s.btime;
+                int inc  = (turn == Colours::WHITE) ? s.winc  : s.binc;
+
+                limited = true;
+                if (s.time){
+                    // movetime, use all of it
+                    soft_limit = s.time;
+                    hard_limit = s.time;
+                }
+                else if (s.wtime || s.btime || s.winc || s.binc){
+                    setClockLimits(time, inc, s.movestogo);
+                }
+                else{
+                    limited = false;
+                }
+            }
+
+            /// @brief starts the clock again without changing the limits. on ponderhit our clock starts when the opponent plays the pondered move
+            void restart(){
+                start_time = now();
+            }
+
+            int elapsed(){
+                return now() - start_time;
+            }
+
+            static int64_t now(){
+                return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            /// @brief whether the search should stop now
+            /// @return
+            bool hardLimitReached(){
+                return limited && elapsed() >= hard_limit;
+            }
+
+            /// @brief whether another iteration of iterative deepening shouldnt be started
+            /// @return
+            bool softLimitReached(){
+                return limited && elapsed() >= soft_limit;
+            }
+
+        private:
+            /// @brief sets the limits when playing with a clock
+            /// @param time time left on the clock
+            /// @param inc
+            /// @param movestogo moves until the next time control, 0 if its sudden death
+            void setClockLimits(int time, int inc, int movestogo){
+                // subtract lichess ping from the time it has and the time it uses
+                // subtracting from the time it has simulates the time it takes to reach this point
+                // subtracting from the time it uses simulates the time it takes to get to lichess/output
+                time -= Lichess::ping;
+
+                int t;
+                if (movestogo){
+                    t = inc + time / movestogo;
+                }
+                else if (time < 10000){
+                    t = inc + 100; // if below 10 seconds, make it use ~100ms a turn
+                }
+                else{
+                    t = inc + time / Values::Time::MOVES_TO_GO; // if above 10s, use 1/20th of its time remaining
+                }
+
+                // cap the time used to time so it doesnt flag
+                t = std::min(time, t);
+                t -= Lichess::ping;
+
+                // the hard limit lets an iteration which is nearly done finish, without using more than a fraction of the clock
+                soft_limit = std::max(1, t);
+                hard_limit = std::max(soft_limit, std::min(t * Values::Time::HARD_LIMIT_SCALE, time / Values::Time::HARD_LIMIT_CLOCK_FRACTION));
+            }
+    };
+
+} // namespace Chess::Engine
+
+
+#endif
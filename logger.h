@@ -7,7 +7,7 @@
 
 namespace Logger{
 
-    void log(std::string info){
+    void log(const std::string& info){
         std::ofstream save_file("engine-logs\\logsv3.txt", std::ios::app);
         save_file << info;
         save_file.close();
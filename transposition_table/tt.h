@@ -3,6 +3,8 @@
 #define TT_H
 
 #include <vector>
+#include <array>
+#include <atomic>
 
 #include "zobrist.h"
 #include "../engine/engine_types.h"
@@ -47,6 +49,8 @@ namespace Chess::Engine::TT{
     void save(Zobrist::Hash hash, Evaluation eval, Depth depth, Move move, int node_type){
         if (table.size() == 0){ return; }
         int index = getIndex(hash);
+        // qsearch entries are depth 0 and cheap to search again, dont let them replace an entry from negamax
+        if (depth <= 0 && table[index].depth > 0) return;
         if (table[index].hash == 0 && table[index].eval == 0) filled++;
         table[index] = TTData(hash, eval, depth, move, node_type);
     }
@@ -58,6 +62,29 @@ namespace Chess::Engine::TT{
         filled = 0;
     }
 
+
+    // counts how many threads are currently searching a position. used by ABDADA so that threads defer moves that another thread is already searching
+    // collisions only cause a move to be searched later so the table is kept small and doesnt store hashes
+    constexpr int SEARCHING_SIZE = 1 << 16;
+
+    std::array<std::atomic<uint16_t>, SEARCHING_SIZE> searching; // wider than the Threads maximum, so it cant wrap back to 0
+
+    int getSearchingIndex(Zobrist::Hash hash){
+        return (hash >> 32) & (SEARCHING_SIZE - 1);
+    }
+
+    bool isBeingSearched(Zobrist::Hash hash){
+        return searching[getSearchingIndex(hash)] > 0;
+    }
+
+    void startSearching(Zobrist::Hash hash){
+        searching[getSearchingIndex(hash)]++;
+    }
+
+    void finishSearching(Zobrist::Hash hash){
+        searching[getSearchingIndex(hash)]--;
+    }
+
 } // namespace Chess::Engine::TT
 
 
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <chrono>
 #include <functional>
+#include <thread>
+#include <cctype>
 
 #include "chess/board.h"
 #include "engine/engine.h"
@@ -18,18 +20,56 @@ void loop(){
     Chess::LegalMovesArray legal_moves;
     Chess::Engine::Engine  engine;
 
+    // the search runs on its own thread so stop, isready and quit are answered while its searching
+    std::thread search_thread;
+    auto stopSearch = [&](){
+        engine.pondering   = false;
+        engine.stop_search = true;
+        if (search_thread.joinable()) search_thread.join();
+    };
+
     while (true){
-        std::getline(std::cin, cmd);
+        if (!std::getline(std::cin, cmd)){
+            cmd = "quit";
+        }
+
         if (cmd == "quit"){
-            // engine.stop_search = true;
-            // t.join();
+            stopSearch();
             return;
         }
 
+        else if (cmd == "stop"){
+            // the search thread prints bestmove when it stops
+            stopSearch();
+        }
+
+        else if (cmd == "ponderhit"){
+            // the opponent played the ponder move, the search carries on with the time limits from the go command
+            engine.ponderhit();
+        }
+
+        else if (cmd == "debug on" || cmd == "debug off"){
+            engine.debug = cmd == "debug on";
+        }
+
         else if (cmd == "uci"){
             std::cout << "id name DDragon_Engine\n";
             std::cout << "id author DDragon\n";
             std::cout << "option name Hash type spin default 64 min 1 max 4096\n";
+            std::cout << "option name Ponder type check default false\n";
+            std::cout << "option name MultiPV type spin default 1 min 1 max 256\n";
+            std::cout << "option name Threads type spin default 1 min 1 max 256\n";
+            std::cout << "option name SMPMode type combo default LazySMP var LazySMP var ABDADA\n";
+            std::cout << "option name MoveOrdering type combo default History var History var Eval\n";
+            std::cout << "option name SearchMode type combo default AlphaBeta var AlphaBeta var MCTS\n";
+            std::cout << "option name RootSearch type combo default PVS var PVS var MTDF\n";
+            std::cout << "option name MCTSLeaf type combo default QSearch var QSearch var Static\n";
+            std::cout << "option name MCTSHash type spin default " << Chess::Engine::Values::MCTS::HASH_MB << " min 1 max 4096\n";
+            std::cout << "option name ReverseFutilityMargin type spin default " << Chess::Engine::Values::Negamax::REVERSE_FUTILITY_MARGIN << " min 0 max 1000\n";
+            std::cout << "option name FutilityMargin type spin default "        << Chess::Engine::Values::Negamax::FUTILITY_MARGIN         << " min 0 max 1000\n";
+            std::cout << "option name RazoringMargin type spin default "        << Chess::Engine::Values::Negamax::RAZORING_DELTA          << " min 0 max 1000\n";
+            std::cout << "option name LateMovePruningBase type spin default "   << Chess::Engine::Values::Negamax::LATE_MOVE_PRUNING_BASE  << " min 0 max 100\n";
+            std::cout << "option name HistoryPruningMargin type spin default "  << Chess::Engine::Values::Negamax::HISTORY_PRUNING_MARGIN  << " min 0 max 32768\n";
             std::cout << "uciok\n";
         }
 
@@ -102,11 +142,23 @@ void loop(){
         }
 
         else if (cmd.substr(0, 2) == "go"){
+            stopSearch();
 
             Chess::Engine::SearchLimit search_limit = Chess::Engine::Values::NO_LIMIT;
+            bool infinite = false;
+            bool ponder   = false;
+            bool reading_searchmoves = false;
+            engine.search_moves.clear();
             std::istringstream iss(cmd);
             iss >> token;
             while (iss >> token) {
+                // moves after searchmoves, until the next keyword
+                if (reading_searchmoves && token.length() >= 4 && isdigit(token[1]) && isdigit(token[3])){
+                    engine.search_moves.emplace_back(Chess::Visuals::stringToMove(token, board));
+                    continue;
+                }
+                reading_searchmoves = false;
+
                 // add limits
                 if (token == "time"){
                     iss >> search_limit.time;
@@ -126,12 +178,30 @@ void loop(){
                 else if (token == "binc"){
                     iss >> search_limit.binc;
                 }
+                else if (token == "nodes"){
+                    iss >> search_limit.nodes;
+                }
+                else if (token == "movetime"){
+                    iss >> search_limit.time;
+                }
+                else if (token == "movestogo"){
+                    iss >> search_limit.movestogo;
+                }
+                else if (token == "mate"){
+                    iss >> search_limit.mate; // solved by the proof number search
+                }
+                else if (token == "infinite"){
+                    infinite = true; // no limits, search until stop
+                }
+                else if (token == "ponder"){
+                    ponder = true; // search on the opponents time until ponderhit or stop
+                }
+                else if (token == "searchmoves"){
+                    reading_searchmoves = true; // only search these root moves
+                }
             }
 
-            engine.stop_search = true;
-            // t.join();
-
-            if (search_limit == Chess::Engine::Values::NO_LIMIT){
+            if (search_limit == Chess::Engine::Values::NO_LIMIT && !infinite){
                 search_limit = Chess::Engine::Values::DEFAULT_LIMIT;
             }
 
@@ -139,12 +209,16 @@ void loop(){
             Logger::log("Go cmd: " + cmd + "\n");
             Logger::log("Go Fen: " + board.toFen() + "\n");
 
-            engine.go(board, search_limit);
-
-
+            // the search gets its own copy of the board so position commands dont change it
+            engine.stop_search = false;
+            engine.pondering   = ponder;
+            search_thread = std::thread([&engine, board, search_limit]() mutable {
+                engine.go(board, search_limit);
+            });
         }
 
         else if (cmd == "moves"){
+            stopSearch();
             Chess::LegalMovesArray legal_moves = move_generator.getLegalMoves(board);
             engine.sortMoves<false>(board, legal_moves, -Chess::Engine::Evaluations::EVAL_INF, Chess::Engine::Evaluations::EVAL_INF);
             std::cout << "Legal moves:\n";
@@ -163,9 +237,25 @@ void loop(){
             }
         }
 
+        else if (cmd.substr(0, 5) == "bench"){
+            stopSearch();
+            // bench [depth], searched with the RootSearch option
+            std::istringstream iss(cmd);
+            iss >> token;
+
+            Chess::Engine::Depth depth = Chess::Engine::Test::BENCH_DEPTH;
+            if (iss >> token){
+                depth = std::stoi(token);
+            }
+
+            Chess::Engine::Test::bench(depth, engine.root_search);
+        }
+
         else if (cmd.substr(0, 10) == "enginetest"){
+            stopSearch();
             // enginetest -l short -s time 2000 -c 4 (~0.925)
             // enginetest -l long -s time 2000 -c 4
+            // enginetest -l short -s time 2000 -c 4 -th 4 -m abdada (compare against -m lazysmp)
 
             std::istringstream iss(cmd);
             iss >> token;
@@ -174,6 +264,8 @@ void loop(){
             std::vector<std::string> puzzle_lengths;
             int count = 4;
             int print = 1;
+            int threads = 1;
+            int smp_mode = Chess::Engine::Values::SMP::LAZY_SMP;
             Chess::Engine::SearchLimit search_limit = Chess::Engine::Values::NO_LIMIT;
 
             // loop through iss. If the first char is '-' change the vector that gets changed
@@ -200,6 +292,14 @@ void loop(){
                         arg_type = 5;
                         continue;
                     }
+                    else if (token == "-th" || token == "-threads"){
+                        arg_type = 6;
+                        continue;
+                    }
+                    else if (token == "-m" || token == "-mode" || token == "-smpmode"){
+                        arg_type = 7;
+                        continue;
+                    }
                 }
                 if (arg_type == 1){
                     puzzle_types.emplace_back(token);
@@ -229,10 +329,19 @@ void loop(){
                     else if (token == "binc"){
                         iss >> search_limit.binc;
                     }
+                    else if (token == "nodes"){
+                        iss >> search_limit.nodes;
+                    }
                 }
                 if (arg_type == 5){
                     print = stoi(token);
                 }
+                if (arg_type == 6){
+                    threads = std::max(1, stoi(token));
+                }
+                if (arg_type == 7){
+                    smp_mode = (token == "abdada") ? Chess::Engine::Values::SMP::ABDADA : Chess::Engine::Values::SMP::LAZY_SMP;
+                }
             }
 
             if (puzzle_types.size() == 0){
@@ -246,11 +355,12 @@ void loop(){
                 search_limit = Chess::Engine::Values::DEFAULT_LIMIT;
             }
 
-            Chess::Engine::Test::doTest(puzzle_types, puzzle_lengths, count, search_limit, print);
+            Chess::Engine::Test::doTest(puzzle_types, puzzle_lengths, count, search_limit, print, threads, smp_mode);
             std::cout << "Done\n";
         }
 
         else if (cmd == "ucinewgame") {
+            stopSearch();
             board.setStartingBoard();
             Chess::Engine::TT::clear();
         }
@@ -261,6 +371,7 @@ void loop(){
         }
 
         else if (cmd == "eval") {
+            stopSearch();
             if (board.turn == Chess::Colours::WHITE){
                 std::cout << "Normal: " << engine.staticEvaluate    <Chess::Colours::WHITE>(board) << '\n';
                 std::cout << "Fast:   " << engine.fastStaticEvaluate<Chess::Colours::WHITE>(board) << '\n';
@@ -271,16 +382,13 @@ void loop(){
             }
         }
 
-        // else if (cmd == "stop") {
-        //     engine.stop_search = true;
-        //     t.join();
-        // }
-
         else if (cmd == "setoption name Clear Hash"){
+            stopSearch();
             Chess::Engine::TT::clear();
         }
 
         else if (cmd.substr(0, 9) == "setoption") {
+            stopSearch();
             std::istringstream iss(cmd);
 
             std::string name, value;
@@ -302,6 +410,45 @@ void loop(){
                 int mb = std::stoi(value);
                 Chess::Engine::TT::resize(mb);
             }
+            else if (name == "MultiPV") {
+                engine.multi_pv = std::max(1, std::stoi(value));
+            }
+            else if (name == "Threads") {
+                engine.thread_count = std::max(1, std::stoi(value));
+            }
+            else if (name == "SMPMode") {
+                engine.smp_mode = (value == "ABDADA") ? Chess::Engine::Values::SMP::ABDADA : Chess::Engine::Values::SMP::LAZY_SMP;
+            }
+            else if (name == "MoveOrdering") {
+                engine.move_ordering_mode = (value == "Eval") ? Chess::Engine::Values::MoveOrdering::EVAL : Chess::Engine::Values::MoveOrdering::HISTORY;
+            }
+            else if (name == "SearchMode") {
+                engine.search_mode = (value == "MCTS") ? Chess::Engine::Values::SearchMode::MCTS : Chess::Engine::Values::SearchMode::ALPHA_BETA;
+            }
+            else if (name == "RootSearch") {
+                engine.root_search = (value == "MTDF") ? Chess::Engine::Values::RootSearch::MTDF : Chess::Engine::Values::RootSearch::PVS;
+            }
+            else if (name == "MCTSLeaf") {
+                engine.mcts_leaf = (value == "Static") ? Chess::Engine::Values::MCTS::LEAF_STATIC : Chess::Engine::Values::MCTS::LEAF_QSEARCH;
+            }
+            else if (name == "MCTSHash") {
+                Chess::Engine::Values::MCTS::HASH_MB = std::stoi(value); // the node pool is resized at the start of the next tree search
+            }
+            else if (name == "ReverseFutilityMargin") {
+                Chess::Engine::Values::Negamax::REVERSE_FUTILITY_MARGIN = std::stoi(value);
+            }
+            else if (name == "FutilityMargin") {
+                Chess::Engine::Values::Negamax::FUTILITY_MARGIN = std::stoi(value);
+            }
+            else if (name == "RazoringMargin") {
+                Chess::Engine::Values::Negamax::RAZORING_DELTA = std::stoi(value);
+            }
+            else if (name == "LateMovePruningBase") {
+                Chess::Engine::Values::Negamax::LATE_MOVE_PRUNING_BASE = std::stoi(value);
+            }
+            else if (name == "HistoryPruningMargin") {
+                Chess::Engine::Values::Negamax::HISTORY_PRUNING_MARGIN = std::stoi(value);
+            }
         }
 
         else{
@@ -320,7 +467,7 @@ void loop(){
 
 int main(){
     Chess::Zobrist::initialise();
-    // Chess::Engine::TT::clear();
+    Chess::Engine::TT::resize(64); // default hash size, threads share results through the table
 
     std::cout << sizeof(Chess::Engine::TT::TTData) << '\n';
     std::cout << "Start\n";